@@ -0,0 +1,91 @@
+#include "body_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sqscpp {
+BodyPool::BodyPool()
+    : chunk_pos(nullptr),
+      chunk_end(nullptr),
+      next_chunk_size(MIN_CHUNK_SIZE),
+      counters{0, 0, 0} {
+  free_lists.fill(nullptr);
+}
+
+size_t BodyPool::size_class(size_t n) {
+  return n == 0 ? 0 : (n - 1) / BLOCK_ALIGN;
+}
+
+void BodyPool::push_free(size_t cls, std::byte* block) {
+  auto free_block = reinterpret_cast<FreeBlock*>(block);
+  free_block->next = free_lists[cls];
+  free_lists[cls] = free_block;
+}
+
+void* BodyPool::allocate(size_t n) {
+  if (n > MAX_BLOCK_SIZE) {
+    return ::operator new(n);
+  }
+
+  auto cls = size_class(n);
+  auto block_size = (cls + 1) * BLOCK_ALIGN;
+  std::lock_guard lock(mtx);
+  counters.bytes_in_use += block_size;
+  counters.blocks_in_use++;
+
+  if (free_lists[cls] != nullptr) {
+    auto block = free_lists[cls];
+    free_lists[cls] = block->next;
+    return block;
+  }
+
+  if (chunk_end - chunk_pos < (ptrdiff_t)block_size) {
+    // the tail of the current chunk is too small, it becomes a free block of
+    // a smaller class instead of being wasted
+    if (chunk_end - chunk_pos >= (ptrdiff_t)BLOCK_ALIGN) {
+      push_free(size_class(chunk_end - chunk_pos), chunk_pos);
+    }
+    chunks.push_back(
+        std::make_unique_for_overwrite<std::byte[]>(next_chunk_size));
+    chunk_pos = chunks.back().get();
+    chunk_end = chunk_pos + next_chunk_size;
+    counters.bytes_reserved += next_chunk_size;
+    next_chunk_size = std::min(next_chunk_size * 2, MAX_CHUNK_SIZE);
+  }
+
+  auto block = chunk_pos;
+  chunk_pos += block_size;
+  return block;
+}
+
+void BodyPool::deallocate(void* p, size_t n) {
+  if (n > MAX_BLOCK_SIZE) {
+    ::operator delete(p);
+    return;
+  }
+
+  auto cls = size_class(n);
+  std::lock_guard lock(mtx);
+  push_free(cls, static_cast<std::byte*>(p));
+  counters.bytes_in_use -= (cls + 1) * BLOCK_ALIGN;
+  counters.blocks_in_use--;
+}
+
+BodyPoolStats BodyPool::stats() {
+  std::lock_guard lock(mtx);
+  return counters;
+}
+
+Body pooled_body(const std::shared_ptr<BodyPool>& pool,
+                 std::string&& content) {
+  // leaves room for the control block allocate_shared puts in front
+  if (content.size() + 96 > BodyPool::MAX_BLOCK_SIZE) {
+    return Body(std::move(content));
+  }
+
+  auto bytes = std::allocate_shared_for_overwrite<char[]>(
+      BodyPoolAllocator<char>(pool), content.size());
+  std::memcpy(bytes.get(), content.data(), content.size());
+  return Body(std::shared_ptr<const char>(bytes, bytes.get()), content.size());
+}
+}  // namespace sqscpp
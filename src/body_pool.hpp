@@ -0,0 +1,92 @@
+#ifndef SQSCPP_BODY_POOL_H
+#define SQSCPP_BODY_POOL_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "message.hpp"
+
+namespace sqscpp {
+struct BodyPoolStats {
+  // slab memory taken from the heap, never returned while the pool lives
+  size_t bytes_reserved;
+  // bytes of the blocks currently handed out, rounded up to their size class
+  size_t bytes_in_use;
+  size_t blocks_in_use;
+};
+
+// Slab allocator for small message bodies of a single queue.
+//
+// Memory is taken from the heap in chunks, starting small so that idle queues
+// stay cheap and doubling up to MAX_CHUNK_SIZE, and carved into blocks of
+// size classes BLOCK_ALIGN bytes apart. Freed blocks go to the free list of
+// their class and are reused by later allocations, so steady send/delete
+// churn does not fragment the process heap. Requests above MAX_BLOCK_SIZE
+// fall through to the heap.
+//
+// Bodies may outlive their queue and are freed from any handler thread, so
+// the pool is refcounted by its allocators and synchronised by itself.
+class BodyPool {
+ public:
+  static constexpr size_t MAX_BLOCK_SIZE = 1024;
+
+ private:
+  static constexpr size_t BLOCK_ALIGN = 16;
+  static constexpr size_t MIN_CHUNK_SIZE = 4 * 1024;
+  static constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  std::mutex mtx;
+  // indexed by size class, class `i` holds blocks of (i + 1) * BLOCK_ALIGN
+  std::array<FreeBlock*, MAX_BLOCK_SIZE / BLOCK_ALIGN> free_lists;
+  std::vector<std::unique_ptr<std::byte[]>> chunks;
+  std::byte* chunk_pos;
+  std::byte* chunk_end;
+  size_t next_chunk_size;
+  BodyPoolStats counters;
+
+  static size_t size_class(size_t n);
+  void push_free(size_t cls, std::byte* block);
+
+ public:
+  BodyPool();
+  void* allocate(size_t n);
+  void deallocate(void* p, size_t n);
+  BodyPoolStats stats();
+};
+
+// Standard allocator drawing from a BodyPool, keeps the pool alive for as
+// long as memory allocated through it is.
+template <typename T>
+struct BodyPoolAllocator {
+  using value_type = T;
+  std::shared_ptr<BodyPool> pool;
+
+  BodyPoolAllocator(std::shared_ptr<BodyPool> p) : pool(std::move(p)) {}
+  template <typename U>
+  BodyPoolAllocator(const BodyPoolAllocator<U>& other) : pool(other.pool) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(pool->allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) { pool->deallocate(p, n * sizeof(T)); }
+
+  template <typename U>
+  bool operator==(const BodyPoolAllocator<U>& other) const {
+    return pool == other.pool;
+  }
+};
+
+// Copies small bodies into a single pooled block holding both the bytes and
+// the refcount, larger ones are moved into a heap allocated Body.
+Body pooled_body(const std::shared_ptr<BodyPool>& pool, std::string&& content);
+}  // namespace sqscpp
+
+#endif  // SQSCPP_BODY_POOL_H
@@ -0,0 +1,50 @@
+#include "body_pool.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace sqscpp;
+
+TEST(body_pool_test, pooled_body_holds_content) {
+  auto pool = std::make_shared<BodyPool>();
+  auto body = pooled_body(pool, "hello");
+
+  EXPECT_EQ(body.view(), "hello");
+  EXPECT_EQ(pool->stats().blocks_in_use, 1);
+  EXPECT_EQ(pool->stats().bytes_reserved, 4 * 1024);
+}
+
+TEST(body_pool_test, large_body_bypasses_pool) {
+  auto pool = std::make_shared<BodyPool>();
+  auto body = pooled_body(pool, std::string(BodyPool::MAX_BLOCK_SIZE, 'x'));
+
+  EXPECT_EQ(body.size(), BodyPool::MAX_BLOCK_SIZE);
+  EXPECT_EQ(pool->stats().blocks_in_use, 0);
+  EXPECT_EQ(pool->stats().bytes_reserved, 0);
+}
+
+TEST(body_pool_test, freed_blocks_are_recycled) {
+  auto pool = std::make_shared<BodyPool>();
+  std::vector<Body> bodies;
+  for (int i = 0; i < 10000; i++) {
+    bodies.push_back(pooled_body(pool, std::string(100, 'x')));
+  }
+  auto reserved = pool->stats().bytes_reserved;
+
+  bodies.clear();
+  EXPECT_EQ(pool->stats().blocks_in_use, 0);
+  EXPECT_EQ(pool->stats().bytes_in_use, 0);
+
+  for (int i = 0; i < 10000; i++) {
+    bodies.push_back(pooled_body(pool, std::string(100, 'y')));
+  }
+  EXPECT_EQ(pool->stats().bytes_reserved, reserved);
+  EXPECT_EQ(bodies.back().view(), std::string(100, 'y'));
+}
+
+TEST(body_pool_test, body_outlives_pool_owner) {
+  auto pool = std::make_shared<BodyPool>();
+  auto body = pooled_body(pool, "hello");
+  pool.reset();
+
+  EXPECT_EQ(body.view(), "hello");
+}
@@ -0,0 +1,250 @@
+#include "cbor.hpp"
+
+#include <limits>
+
+namespace sqscpp {
+// additional information of an initial byte
+const uint8_t ONE_BYTE_ARG = 24;
+const uint8_t INDEFINITE = 31;
+const uint8_t SIMPLE_FALSE = 20;
+const uint8_t SIMPLE_TRUE = 21;
+const uint8_t SIMPLE_NULL = 22;
+const uint8_t SIMPLE_UNDEFINED = 23;
+const uint8_t BREAK = 0xff;
+
+void CborWriter::write_head(CborMajor major, uint64_t arg) {
+  uint8_t initial = major << 5;
+  if (arg < ONE_BYTE_ARG) {
+    out.push_back(initial | arg);
+    return;
+  }
+
+  // 24 to 27 announce an argument of 1, 2, 4 or 8 bytes
+  uint8_t info = ONE_BYTE_ARG;
+  int bytes = 1;
+  while (bytes < 8 && arg >> (8 * bytes) != 0) {
+    info++;
+    bytes *= 2;
+  }
+  out.push_back(initial | info);
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+    out.push_back(arg >> shift);
+  }
+}
+
+void CborWriter::reserve(size_t bytes) { out.reserve(bytes); }
+
+void CborWriter::write_map(size_t pairs) { write_head(CborMap, pairs); }
+
+void CborWriter::write_array(size_t items) { write_head(CborArray, items); }
+
+void CborWriter::write_string(std::string_view str) {
+  write_head(CborText, str.size());
+  out.append(str);
+}
+
+void CborWriter::write_int(long value) {
+  if (value < 0) {
+    write_head(CborNegative, -1 - value);
+  } else {
+    write_head(CborUnsigned, value);
+  }
+}
+
+void CborWriter::write_bool(bool value) {
+  out.push_back(CborSimple << 5 | (value ? SIMPLE_TRUE : SIMPLE_FALSE));
+}
+
+std::string CborWriter::take() { return std::move(out); }
+
+CborReader::CborReader(std::string_view input)
+    : data(input), pos(0), failed(false) {}
+
+bool CborReader::fail() {
+  failed = true;
+  return false;
+}
+
+std::optional<CborReader::Head> CborReader::read_head() {
+  if (failed || pos >= data.size()) {
+    fail();
+    return {};
+  }
+  uint8_t initial = data[pos++];
+  auto major = static_cast<CborMajor>(initial >> 5);
+  uint8_t info = initial & 0x1f;
+  if (info < ONE_BYTE_ARG) {
+    return Head{major, info, false};
+  }
+  if (info == INDEFINITE) {
+    // only strings, arrays and maps come in chunks, a break ends nothing
+    if (major < CborBytes || major > CborMap) {
+      fail();
+      return {};
+    }
+    return Head{major, 0, true};
+  }
+  if (info > ONE_BYTE_ARG + 3) {
+    fail();
+    return {};
+  }
+
+  size_t bytes = 1 << (info - ONE_BYTE_ARG);
+  if (data.size() - pos < bytes) {
+    fail();
+    return {};
+  }
+  uint64_t arg = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    arg = arg << 8 | (uint8_t)data[pos++];
+  }
+  return Head{major, arg, false};
+}
+
+std::optional<CborReader::Head> CborReader::read_head(CborMajor major) {
+  auto head = read_head();
+  if (head.has_value() && head->major != major) {
+    fail();
+    return {};
+  }
+  return head;
+}
+
+bool CborReader::read_break() {
+  if (failed || pos >= data.size()) {
+    return fail();
+  }
+  if ((uint8_t)data[pos] != BREAK) {
+    return false;
+  }
+  pos++;
+  return true;
+}
+
+std::optional<std::string_view> CborReader::read_text(std::string& chunks) {
+  auto head = read_head(CborText);
+  if (!head.has_value()) {
+    return {};
+  }
+  if (!head->indefinite) {
+    if (data.size() - pos < head->arg) {
+      fail();
+      return {};
+    }
+    auto text = data.substr(pos, head->arg);
+    pos += head->arg;
+    return text;
+  }
+
+  chunks.clear();
+  while (!read_break()) {
+    // chunks are definite-length text strings themselves
+    auto chunk = read_head(CborText);
+    if (!chunk.has_value() || chunk->indefinite ||
+        data.size() - pos < chunk->arg) {
+      fail();
+      return {};
+    }
+    chunks.append(data.substr(pos, chunk->arg));
+    pos += chunk->arg;
+  }
+  if (failed) {
+    return {};
+  }
+  return chunks;
+}
+
+bool CborReader::next_is_null() {
+  if (failed || pos >= data.size()) {
+    return false;
+  }
+  uint8_t initial = data[pos];
+  return initial == (CborSimple << 5 | SIMPLE_NULL) ||
+         initial == (CborSimple << 5 | SIMPLE_UNDEFINED);
+}
+
+std::optional<std::string> CborReader::read_string() {
+  std::string chunks;
+  auto text = read_text(chunks);
+  if (!text.has_value()) {
+    return {};
+  }
+  return std::string(text.value());
+}
+
+std::optional<long> CborReader::read_int() {
+  auto head = read_head();
+  if (!head.has_value()) {
+    return {};
+  }
+  if ((head->major != CborUnsigned && head->major != CborNegative) ||
+      head->arg > (uint64_t)std::numeric_limits<long>::max()) {
+    fail();
+    return {};
+  }
+  long value = head->arg;
+  return head->major == CborUnsigned ? value : -1 - value;
+}
+
+std::optional<bool> CborReader::read_bool() {
+  auto head = read_head(CborSimple);
+  if (!head.has_value() ||
+      (head->arg != SIMPLE_FALSE && head->arg != SIMPLE_TRUE)) {
+    fail();
+    return {};
+  }
+  return head->arg == SIMPLE_TRUE;
+}
+
+bool CborReader::skip() { return skip(0); }
+
+bool CborReader::skip(int depth) {
+  if (depth > MAX_DEPTH) {
+    return fail();
+  }
+  auto head = read_head();
+  if (!head.has_value()) {
+    return false;
+  }
+  switch (head->major) {
+    case CborBytes:
+    case CborText:
+      if (head->indefinite) {
+        while (!read_break()) {
+          auto chunk = read_head(head->major);
+          if (!chunk.has_value() || chunk->indefinite ||
+              data.size() - pos < chunk->arg) {
+            return fail();
+          }
+          pos += chunk->arg;
+        }
+      } else {
+        if (data.size() - pos < head->arg) {
+          return fail();
+        }
+        pos += head->arg;
+      }
+      break;
+    case CborArray:
+    case CborMap: {
+      // a map holds a key and a value per pair
+      uint64_t items = head->major == CborMap ? 2 * head->arg : head->arg;
+      for (uint64_t i = 0; head->indefinite || i < items; i++) {
+        if (head->indefinite && read_break()) {
+          break;
+        }
+        if (!skip(depth + 1)) {
+          return false;
+        }
+      }
+      break;
+    }
+    case CborTag:
+      return skip(depth + 1);
+    default:
+      // integers and simple values are all head, floats included
+      break;
+  }
+  return !failed;
+}
+}  // namespace sqscpp
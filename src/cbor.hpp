@@ -0,0 +1,139 @@
+#ifndef SQSCPP_CBOR_H
+#define SQSCPP_CBOR_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sqscpp {
+// major types of CBOR items (RFC 8949)
+enum CborMajor : uint8_t {
+  CborUnsigned = 0,
+  CborNegative = 1,
+  CborBytes = 2,
+  CborText = 3,
+  CborArray = 4,
+  CborMap = 5,
+  CborTag = 6,
+  CborSimple = 7
+};
+
+// Encodes CBOR items straight into a buffer. Maps and arrays are written
+// with their length up front and followed by their items.
+class CborWriter {
+ private:
+  std::string out;
+
+  void write_head(CborMajor major, uint64_t arg);
+
+ public:
+  void reserve(size_t bytes);
+  // starts a map of `pairs` keys and values
+  void write_map(size_t pairs);
+  void write_array(size_t items);
+  void write_string(std::string_view str);
+  void write_int(long value);
+  void write_bool(bool value);
+  std::string take();
+};
+
+// Decodes CBOR items one at a time from a buffer, without building a
+// document. A read of malformed input, or of an item of another type than
+// asked for, fails the reader, and every read after that fails too.
+class CborReader {
+ private:
+  // nesting of arrays, maps and tags skip descends into
+  static constexpr int MAX_DEPTH = 32;
+
+  struct Head {
+    CborMajor major;
+    uint64_t arg;
+    bool indefinite;
+  };
+
+  std::string_view data;
+  size_t pos;
+  bool failed;
+
+  std::optional<Head> read_head();
+  // reads the head of an item of type `major`, failing on any other
+  std::optional<Head> read_head(CborMajor major);
+  // consumes the break ending an indefinite-length item if it is next
+  bool read_break();
+  // A text string, viewed in the input or, when sent in chunks, joined in
+  // `chunks`.
+  std::optional<std::string_view> read_text(std::string& chunks);
+  bool skip(int depth);
+  bool fail();
+
+ public:
+  explicit CborReader(std::string_view input);
+
+  bool ok() { return !failed; }
+  // whether the whole input was read
+  bool at_end() { return !failed && pos == data.size(); }
+  // whether the next item is null or undefined
+  bool next_is_null();
+
+  std::optional<std::string> read_string();
+  std::optional<long> read_int();
+  std::optional<bool> read_bool();
+  // Passes every key of the map that is next to `fn`, which reads or skips
+  // its value. Keys with a null or undefined value are left out, like
+  // absent ones.
+  template <typename Fn>
+  bool read_map(Fn fn);
+  // calls `fn` to read each item of the array that is next
+  template <typename Fn>
+  bool read_array(Fn fn);
+  bool skip();
+};
+
+template <typename Fn>
+bool CborReader::read_map(Fn fn) {
+  auto head = read_head(CborMap);
+  if (!head.has_value()) {
+    return false;
+  }
+  std::string chunks;
+  for (uint64_t i = 0; head->indefinite || i < head->arg; i++) {
+    if (head->indefinite && read_break()) {
+      break;
+    }
+    auto key = read_text(chunks);
+    if (!key.has_value()) {
+      return false;
+    }
+    if (next_is_null()) {
+      skip();
+    } else {
+      fn(key.value());
+    }
+    if (failed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Fn>
+bool CborReader::read_array(Fn fn) {
+  auto head = read_head(CborArray);
+  if (!head.has_value()) {
+    return false;
+  }
+  for (uint64_t i = 0; head->indefinite || i < head->arg; i++) {
+    if (head->indefinite && read_break()) {
+      break;
+    }
+    fn();
+    if (failed) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace sqscpp
+
+#endif  // SQSCPP_CBOR_H
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include "serde.hpp"
+
+using namespace sqscpp;
+
+static std::string to_cbor(const json& j) {
+  auto bytes = json::to_cbor(j);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+static json from_cbor(const std::string& str) { return json::from_cbor(str); }
+
+TEST(cbor_serde_test, error_serialize) {
+  CborSerde serde;
+  Error err;
+  err.message = "test message";
+
+  EXPECT_EQ(from_cbor(serde.serialize(&err)),
+            json({{"message", "test message"}}));
+  EmptyResponse empty;
+  EXPECT_EQ(from_cbor(serde.serialize(&empty)), json::object());
+}
+
+TEST(cbor_serde_test, error_serialize_names_shape) {
+  CborSerde serde;
+  Error err = QueueDoesNotExistError();
+
+  auto res = from_cbor(serde.serialize(&err));
+  EXPECT_EQ(res["__type"], "com.amazonaws.sqs#QueueDoesNotExist");
+  EXPECT_EQ(res["message"], "The specified queue does not exist.");
+  err = BadRequestError("Value for parameter MaxNumberOfMessages is invalid.");
+  res = from_cbor(serde.serialize(&err));
+  EXPECT_EQ(res["__type"], "com.amazonaws.sqs#InvalidParameterValue");
+}
+
+TEST(cbor_serde_test, create_queue_input) {
+  CborSerde serde;
+  auto input = to_cbor({{"QueueName", "test-queue"},
+                        {"Attributes", {{"DelaySeconds", "5"}}},
+                        {"Unknown", {1, 2, 3}}});
+  auto res = serde.deserialize_create_queue_input(input);
+
+  ASSERT_EQ(res.has_value(), true);
+  EXPECT_EQ(res.value()->get_queue_name(), "test-queue");
+  EXPECT_EQ(res.value()->get_attrs().at("DelaySeconds"), "5");
+
+  input = to_cbor({{"Attributes", {{"DelaySeconds", "5"}}}});
+  EXPECT_FALSE(serde.deserialize_create_queue_input(input).has_value());
+  input = to_cbor({{"QueueName", ""}});
+  EXPECT_FALSE(serde.deserialize_create_queue_input(input).has_value());
+  input = to_cbor({{"QueueName", 5}});
+  EXPECT_FALSE(serde.deserialize_create_queue_input(input).has_value());
+  input = "{\"QueueName\":\"test-queue\"}";
+  EXPECT_FALSE(serde.deserialize_create_queue_input(input).has_value());
+}
+
+TEST(cbor_serde_test, list_queues) {
+  CborSerde serde;
+  auto input = to_cbor({{"QueueNamePrefix", "orders-"},
+                        {"MaxResults", 10},
+                        {"NextToken", nullptr}});
+  auto req = serde.deserialize_list_queues_input(input).value();
+  EXPECT_EQ(req->get_queue_name_prefix().value(), "orders-");
+  EXPECT_EQ(req->get_max_results().value(), 10);
+  EXPECT_FALSE(req->get_next_token().has_value());
+
+  std::string empty = "";
+  req = serde.deserialize_list_queues_input(empty).value();
+  EXPECT_FALSE(req->get_queue_name_prefix().has_value());
+
+  ListQueuesResponse res;
+  res.queues = {QueueInfo{"foo", "foo"}, QueueInfo{"bar", "bar"}};
+  res.next_token = "bar";
+  EXPECT_EQ(from_cbor(serde.serialize(&res)),
+            json({{"QueueUrls", {"foo", "bar"}}, {"NextToken", "bar"}}));
+}
+
+TEST(cbor_serde_test, queue_attributes_and_tags) {
+  CborSerde serde;
+  auto input = to_cbor({{"QueueUrl", "test-url"},
+                        {"AttributeNames", {"All"}}});
+  auto req = serde.deserialize_get_queue_attributes_input(input).value();
+  EXPECT_EQ(req->get_queue_url(), "test-url");
+  EXPECT_EQ(req->get_attribute_names(), std::vector<std::string>{"All"});
+
+  input = to_cbor({{"QueueUrl", "test-url"}, {"TagKeys", {"a", "b"}}});
+  auto untag = serde.deserialize_untag_queue_input(input).value();
+  EXPECT_EQ(untag->get_tag_keys(), (std::vector<std::string>{"a", "b"}));
+
+  std::map<std::string, std::string> attrs = {{"VisibilityTimeout", "30"}};
+  GetQueueAttributesResponse res{&attrs};
+  EXPECT_EQ(from_cbor(serde.serialize(&res)),
+            json({{"Attributes", {{"VisibilityTimeout", "30"}}}}));
+}
+
+TEST(cbor_serde_test, send_and_receive_messages) {
+  CborSerde serde;
+  auto input = to_cbor({{"QueueUrl", "test-url"},
+                        {"MessageBody", "hello"},
+                        {"DelaySeconds", 5},
+                        {"MessageGroupId", "g"}});
+  auto send = serde.deserialize_send_message_input(input).value();
+  EXPECT_EQ(send->get_queue_url(), "test-url");
+  EXPECT_EQ(send->get_message_body(), "hello");
+  EXPECT_EQ(send->get_delay_seconds().value(), 5);
+  EXPECT_FALSE(send->get_message_deduplication_id().has_value());
+  EXPECT_EQ(send->get_message_group_id().value(), "g");
+
+  input = to_cbor({{"QueueUrl", "test-url"},
+                   {"MaxNumberOfMessages", 10},
+                   {"WaitTimeSeconds", 20}});
+  auto receive = serde.deserialize_receive_message_input(input).value();
+  EXPECT_EQ(receive->get_max_number_of_messages().value(), 10);
+  EXPECT_EQ(receive->get_wait_time_seconds().value(), 20);
+  EXPECT_FALSE(receive->get_visibility_timeout().has_value());
+
+  // past the range of int, the values saturate instead of wrapping into it
+  input = to_cbor({{"QueueUrl", "test-url"},
+                   {"MaxNumberOfMessages", 4294967297},
+                   {"VisibilityTimeout", -4294967296}});
+  receive = serde.deserialize_receive_message_input(input).value();
+  EXPECT_EQ(receive->get_max_number_of_messages().value(),
+            std::numeric_limits<int>::max());
+  EXPECT_EQ(receive->get_visibility_timeout().value(),
+            std::numeric_limits<int>::min());
+
+  ReceivedMessagesResponse res;
+  res.messages.push_back(
+      ReceivedMessageResponse{"id", "rh", "md5", Body("hello"), 2});
+  EXPECT_EQ(from_cbor(serde.serialize(&res)),
+            json({{"Messages",
+                   {{{"MessageId", "id"},
+                     {"ReceiptHandle", "rh"},
+                     {"MD5OfBody", "md5"},
+                     {"Body", "hello"},
+                     {"Attributes", {{"ApproximateReceiveCount", "2"}}}}}}}));
+}
+
+TEST(cbor_serde_test, batches) {
+  CborSerde serde;
+  json entries = {
+      {{"Id", "a"}, {"ReceiptHandle", "rh-a"}, {"VisibilityTimeout", 0}},
+      {{"Id", "b"}, {"ReceiptHandle", "rh-b"}, {"VisibilityTimeout", 60}}};
+  auto input = to_cbor({{"QueueUrl", "test-url"}, {"Entries", entries}});
+  auto change =
+      serde.deserialize_change_message_visibility_batch_input(input).value();
+  ASSERT_EQ(change->get_entries().size(), 2);
+  EXPECT_EQ(change->get_entries()[1].receipt_handle, "rh-b");
+  EXPECT_EQ(change->get_entries()[1].visibility_timeout, 60);
+
+  input = to_cbor({{"QueueUrl", "test-url"},
+                   {"Entries", {{{"Id", "a"}, {"ReceiptHandle", "rh-a"}}}}});
+  EXPECT_FALSE(serde.deserialize_change_message_visibility_batch_input(input)
+                   .has_value());
+  auto del = serde.deserialize_delete_message_batch_input(input).value();
+  EXPECT_EQ(del->get_entries()[0].id, "a");
+
+  input = to_cbor({{"QueueUrl", "test-url"},
+                   {"Entries", {{{"Id", "a"}, {"MessageBody", "hi"}}}}});
+  auto send = serde.deserialize_send_message_batch_input(input).value();
+  EXPECT_EQ(send->get_entries()[0].message_body, "hi");
+  input = to_cbor({{"QueueUrl", "test-url"}, {"Entries", {{{"Id", "a"}}}}});
+  EXPECT_FALSE(serde.deserialize_send_message_batch_input(input).has_value());
+
+  BatchResponse res;
+  res.successful = {"a"};
+  res.failed = {BatchResultErrorEntry{"b", true, "Code", "message"}};
+  EXPECT_EQ(from_cbor(serde.serialize(&res)),
+            json({{"Successful", {{{"Id", "a"}}}},
+                  {"Failed",
+                   {{{"Id", "b"},
+                     {"SenderFault", true},
+                     {"Code", "Code"},
+                     {"Message", "message"}}}}}));
+}
+
+TEST(cbor_serde_test, list_message_move_tasks) {
+  CborSerde serde;
+  ListMessageMoveTasksResponse res;
+  res.results.push_back(MessageMoveTaskResult{
+      "", "COMPLETED", "src", "dst", {}, 3, 3, "", 1700000000000});
+  EXPECT_EQ(from_cbor(serde.serialize(&res)),
+            json({{"Results",
+                   {{{"Status", "COMPLETED"},
+                     {"SourceArn", "src"},
+                     {"DestinationArn", "dst"},
+                     {"ApproximateNumberOfMessagesMoved", 3},
+                     {"ApproximateNumberOfMessagesToMove", 3},
+                     {"StartedTimestamp", 1700000000000}}}}}));
+}
+
+TEST(cbor_serde_test, read_string_member) {
+  CborSerde serde;
+  auto body = to_cbor({{"Attributes", {{"QueueUrl", "nested"}}},
+                       {"QueueUrl", "http://localhost/1/test"}});
+  EXPECT_EQ(serde.read_string_member(body, "QueueUrl"),
+            "http://localhost/1/test");
+
+  body = to_cbor({{"QueueUrl", 5}});
+  EXPECT_FALSE(serde.read_string_member(body, "QueueUrl").has_value());
+  body = "";
+  EXPECT_FALSE(serde.read_string_member(body, "QueueUrl").has_value());
+}
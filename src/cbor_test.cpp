@@ -0,0 +1,112 @@
+#include "cbor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+using namespace sqscpp;
+using json = nlohmann::json;
+
+static std::string to_cbor(const json& j) {
+  auto bytes = json::to_cbor(j);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+TEST(cbor_test, writer_matches_reference_encoding) {
+  CborWriter w;
+  w.write_map(3);
+  w.write_string("a");
+  w.write_int(23);
+  w.write_string("b");
+  w.write_array(4);
+  w.write_int(24);
+  w.write_int(70000);
+  w.write_int(-500);
+  w.write_int(5000000000);
+  w.write_string("c");
+  w.write_bool(true);
+
+  EXPECT_EQ(w.take(),
+            to_cbor({{"a", 23},
+                     {"b", {24, 70000, -500, 5000000000}},
+                     {"c", true}}));
+}
+
+TEST(cbor_test, reader_reads_what_writer_wrote) {
+  CborWriter w;
+  w.write_array(4);
+  w.write_string(std::string(300, 'x'));
+  w.write_int(-1);
+  w.write_int(65536);
+  w.write_bool(false);
+  auto bytes = w.take();
+
+  CborReader r(bytes);
+  std::vector<std::string> strings;
+  std::vector<long> ints;
+  EXPECT_TRUE(r.read_array([&]() {
+    if (strings.empty()) {
+      strings.push_back(r.read_string().value_or(""));
+    } else if (ints.size() < 2) {
+      ints.push_back(r.read_int().value_or(0));
+    } else {
+      EXPECT_EQ(r.read_bool(), false);
+    }
+  }));
+  EXPECT_TRUE(r.at_end());
+  EXPECT_EQ(strings[0], std::string(300, 'x'));
+  EXPECT_EQ(ints, (std::vector<long>{-1, 65536}));
+}
+
+TEST(cbor_test, reader_joins_indefinite_length_items) {
+  // {_ "key": (_ "hel", "lo"), "nil": null}
+  std::string bytes = "\xbf\x63key\x7f\x63hel\x62lo\xff\x63nil\xf6\xff";
+
+  CborReader r(bytes);
+  std::map<std::string, std::string> read;
+  EXPECT_TRUE(r.read_map([&](std::string_view key) {
+    read[std::string(key)] = r.read_string().value_or("?");
+  }));
+  EXPECT_TRUE(r.at_end());
+  EXPECT_EQ(read, (std::map<std::string, std::string>{{"key", "hello"}}));
+}
+
+TEST(cbor_test, reader_skips_unknown_items) {
+  auto bytes = to_cbor({{"nested", {{"a", {1, 2.5, "x"}}, {"b", nullptr}}},
+                        {"binary", json::binary({1, 2, 3})},
+                        {"wanted", "yes"}});
+
+  CborReader r(bytes);
+  std::optional<std::string> wanted;
+  EXPECT_TRUE(r.read_map([&](std::string_view key) {
+    if (key == "wanted") {
+      wanted = r.read_string();
+    } else {
+      r.skip();
+    }
+  }));
+  EXPECT_TRUE(r.at_end());
+  EXPECT_EQ(wanted, "yes");
+}
+
+TEST(cbor_test, reader_fails_on_malformed_input) {
+  auto bytes = to_cbor({{"key", "value"}});
+
+  CborReader truncated(std::string_view(bytes).substr(0, bytes.size() - 1));
+  EXPECT_FALSE(truncated.read_map([&](std::string_view) {
+    truncated.read_string();
+  }));
+
+  CborReader mistyped(bytes);
+  EXPECT_FALSE(mistyped.read_map([&](std::string_view) {
+    mistyped.read_int();
+  }));
+  EXPECT_FALSE(mistyped.ok());
+  EXPECT_FALSE(mistyped.read_string().has_value());
+
+  // 40 nested arrays
+  std::string deep(40, '\x81');
+  deep.push_back('\x01');
+  CborReader nested(deep);
+  EXPECT_FALSE(nested.skip());
+}
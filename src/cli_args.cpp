@@ -12,7 +12,10 @@ std::pair<bool, CliArgs> parse_cli_args(int argc, char *argv[]) {
   desc.add_options()("help", "print help message")(
       "host", po::value<std::string>(), "target hostname")(
       "port", po::value<int>(), "target port")(
-      "account-number", po::value<std::string>(), "AWS account number");
+      "account-number", po::value<std::string>(), "AWS account number")(
+      "threads", po::value<int>(), "number of threads serving requests")(
+      "shards", po::value<int>(),
+      "number of single-threaded reactors sharing the port");
   po::variables_map vm;
   po::store(po::parse_command_line(argc, argv, desc), vm);
   po::notify(vm);
@@ -37,8 +40,30 @@ std::pair<bool, CliArgs> parse_cli_args(int argc, char *argv[]) {
     account_number = vm["account-number"].as<std::string>();
   }
 
-  return std::pair<bool, CliArgs>(true,
-                                  CliArgs{target_port, host, account_number});
+  int threads = DEFAULT_THREADS;
+  if (vm.contains("threads")) {
+    threads = vm["threads"].as<int>();
+    if (threads < 1) {
+      std::cerr << "--threads must be at least 1\n";
+      return std::pair<bool, CliArgs>(false, CliArgs());
+    }
+  }
+
+  int shards = DEFAULT_SHARDS;
+  if (vm.contains("shards")) {
+    shards = vm["shards"].as<int>();
+    if (shards < 1) {
+      std::cerr << "--shards must be at least 1\n";
+      return std::pair<bool, CliArgs>(false, CliArgs());
+    }
+  }
+  if (threads > 1 && shards > 1) {
+    std::cerr << "--threads and --shards cannot be combined\n";
+    return std::pair<bool, CliArgs>(false, CliArgs());
+  }
+
+  return std::pair<bool, CliArgs>(
+      true, CliArgs{target_port, host, account_number, threads, shards});
 }
 
 std::string endpoint_url(CliArgs *args) {
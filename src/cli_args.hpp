@@ -7,11 +7,18 @@ namespace sqscpp {
 const int DEFAULT_PORT = 8080;
 const std::string DEFAULT_HOST = "0.0.0.0";
 const std::string DEFAULT_ACCOUNT_NUMBER = "000000000000";
+const int DEFAULT_THREADS = 1;
+const int DEFAULT_SHARDS = 1;
 
 struct CliArgs {
   int port;
   std::string host;
   std::string account_number;
+  // threads serving requests, 1 runs the server on the main thread
+  int threads;
+  // single-threaded reactors listening on the address with SO_REUSEPORT,
+  // exclusive with threads
+  int shards;
 };
 
 std::pair<bool, CliArgs> parse_cli_args(int argc, char *argv[]);
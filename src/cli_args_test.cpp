@@ -71,3 +71,39 @@ TEST(cli_args_test, endpoint_url) {
   auto args = CliArgs(9999, "localhost", "123456789012");
   EXPECT_EQ(endpoint_url(&args), "http://localhost:9999/123456789012");
 }
+
+TEST(cli_args_test, parse_cli_args_parse_threads) {
+  std::vector<std::string> cmd = {"sqscpp", "--threads", "8"};
+  auto argv = as_argv(&cmd);
+  auto res = parse_cli_args(argv.size() - 1, argv.data());
+
+  EXPECT_EQ(res.first, true);
+  EXPECT_EQ(res.second.threads, 8);
+  EXPECT_EQ(res.second.port, DEFAULT_PORT);
+}
+
+TEST(cli_args_test, parse_cli_args_rejects_no_threads) {
+  std::vector<std::string> cmd = {"sqscpp", "--threads", "0"};
+  auto argv = as_argv(&cmd);
+  auto res = parse_cli_args(argv.size() - 1, argv.data());
+
+  EXPECT_EQ(res.first, false);
+}
+
+TEST(cli_args_test, parse_cli_args_parse_shards) {
+  std::vector<std::string> cmd = {"sqscpp", "--shards", "4"};
+  auto argv = as_argv(&cmd);
+  auto res = parse_cli_args(argv.size() - 1, argv.data());
+
+  EXPECT_EQ(res.first, true);
+  EXPECT_EQ(res.second.shards, 4);
+  EXPECT_EQ(res.second.threads, DEFAULT_THREADS);
+}
+
+TEST(cli_args_test, parse_cli_args_rejects_threads_with_shards) {
+  std::vector<std::string> cmd = {"sqscpp", "--threads", "4", "--shards", "4"};
+  auto argv = as_argv(&cmd);
+  auto res = parse_cli_args(argv.size() - 1, argv.data());
+
+  EXPECT_EQ(res.first, false);
+}
@@ -0,0 +1,37 @@
+#include "dedup_window.hpp"
+
+namespace sqscpp {
+void DedupWindow::expire(long ts) {
+  while (!buckets.empty() &&
+         buckets.front().start + BUCKET_SECONDS + WINDOW_SECONDS <= ts) {
+    for (auto id : buckets.front().ids) {
+      entries.erase(entries.find(id));
+    }
+    buckets.pop_front();
+  }
+}
+
+std::optional<DedupEntry> DedupWindow::find(const std::string& id, long ts) {
+  expire(ts);
+  auto entry = entries.find(id);
+  if (entry == entries.end()) {
+    return {};
+  }
+  return entry->second;
+}
+
+void DedupWindow::insert(std::string id, DedupEntry entry, long ts) {
+  expire(ts);
+  auto [it, inserted] = entries.emplace(std::move(id), entry);
+  if (!inserted) {
+    return;
+  }
+
+  if (buckets.empty() || buckets.back().start + BUCKET_SECONDS <= ts) {
+    buckets.push_back(Bucket{ts - ts % BUCKET_SECONDS, {}});
+  }
+  buckets.back().ids.push_back(it->first);
+}
+
+size_t DedupWindow::size() { return entries.size(); }
+}  // namespace sqscpp
@@ -0,0 +1,63 @@
+#ifndef SQSCPP_DEDUP_WINDOW_H
+#define SQSCPP_DEDUP_WINDOW_H
+
+#include <boost/uuid/uuid.hpp>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "message.hpp"
+
+namespace sqscpp {
+// message a deduplication id was first sent as
+struct DedupEntry {
+  boost::uuids::uuid message_id;
+  Digest md5_of_body;
+};
+
+// Deduplication ids of a FIFO queue seen within the last WINDOW_SECONDS.
+//
+// Ids are kept in a hash set and, in insertion order, in buckets spanning
+// BUCKET_SECONDS each. Whole buckets are dropped once they are older than the
+// window, so every id is inserted and expired once and memory is bounded by
+// the send rate over the window. An id is forgotten between WINDOW_SECONDS
+// and WINDOW_SECONDS + BUCKET_SECONDS after it was first seen.
+//
+// DedupWindow is not synchronised by itself, callers serialise access to it.
+class DedupWindow {
+ public:
+  static constexpr long WINDOW_SECONDS = 300;
+  static constexpr long BUCKET_SECONDS = 10;
+
+ private:
+  // allows looking ids up by std::string_view
+  struct IdHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view id) const {
+      return std::hash<std::string_view>()(id);
+    }
+  };
+  struct Bucket {
+    long start;
+    // views of the keys of `entries`, which are stable until erased
+    std::vector<std::string_view> ids;
+  };
+
+  std::unordered_map<std::string, DedupEntry, IdHash, std::equal_to<>> entries;
+  std::deque<Bucket> buckets;
+
+  void expire(long ts);
+
+ public:
+  std::optional<DedupEntry> find(const std::string& id, long ts);
+  // `id` must not be in the window
+  void insert(std::string id, DedupEntry entry, long ts);
+  size_t size();
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_DEDUP_WINDOW_H
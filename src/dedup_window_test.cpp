@@ -0,0 +1,50 @@
+#include "dedup_window.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/uuid/uuid_generators.hpp>
+
+using namespace sqscpp;
+
+TEST(dedup_window_test, finds_ids_within_window) {
+  boost::uuids::random_generator gen;
+  DedupWindow window;
+  auto entry = DedupEntry{gen(), Digest()};
+  window.insert("a", entry, 1000);
+
+  auto found = window.find("a", 1000 + DedupWindow::WINDOW_SECONDS - 1);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->message_id, entry.message_id);
+  EXPECT_FALSE(window.find("b", 1000).has_value());
+}
+
+TEST(dedup_window_test, expires_whole_buckets) {
+  boost::uuids::random_generator gen;
+  DedupWindow window;
+  window.insert("a", DedupEntry{gen(), Digest()}, 1000);
+  window.insert("b", DedupEntry{gen(), Digest()}, 1005);
+  window.insert("c", DedupEntry{gen(), Digest()}, 1010);
+  EXPECT_EQ(window.size(), 3);
+
+  // a and b share the bucket starting at 1000, c starts the next one
+  auto ts = 1000 + DedupWindow::WINDOW_SECONDS + DedupWindow::BUCKET_SECONDS;
+  EXPECT_FALSE(window.find("b", ts).has_value());
+  EXPECT_FALSE(window.find("a", ts).has_value());
+  EXPECT_TRUE(window.find("c", ts).has_value());
+  EXPECT_EQ(window.size(), 1);
+  EXPECT_FALSE(window.find("c", ts + DedupWindow::BUCKET_SECONDS).has_value());
+  EXPECT_EQ(window.size(), 0);
+}
+
+TEST(dedup_window_test, accepts_expired_id_again) {
+  boost::uuids::random_generator gen;
+  DedupWindow window;
+  window.insert("a", DedupEntry{gen(), Digest()}, 1000);
+  auto ts = 1000 + DedupWindow::WINDOW_SECONDS + DedupWindow::BUCKET_SECONDS;
+  ASSERT_FALSE(window.find("a", ts).has_value());
+
+  auto entry = DedupEntry{gen(), Digest()};
+  window.insert("a", entry, ts);
+  EXPECT_EQ(window.find("a", ts)->message_id, entry.message_id);
+  EXPECT_EQ(window.size(), 1);
+}
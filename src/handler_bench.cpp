@@ -0,0 +1,98 @@
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "serde.hpp"
+#include "sqs.hpp"
+
+using namespace sqscpp;
+
+const int REQUESTS_PER_THREAD = 50000;
+const std::string BODY(256, 'x');
+
+// Requests per second handled by `threads` handler threads, each sending,
+// receiving and deleting messages on a queue of its own, or all of them on
+// one queue striped into `partitions` when that is given. Every request goes
+// through the JSON serde like it does behind the router, the network is left
+// out.
+double throughput(int threads, std::optional<int> partitions = {}) {
+  SQS sqs("http://localhost:8080/000000000000");
+  JsonSerde serde;
+  std::vector<std::string> qurls;
+  for (int t = 0; t < threads; t++) {
+    if (partitions.has_value() && t > 0) {
+      qurls.push_back(qurls[0]);
+      continue;
+    }
+    std::map<std::string, std::string> attrs;
+    if (partitions.has_value()) {
+      attrs["Partitions"] = std::to_string(partitions.value());
+    }
+    auto create = CreateQueueInput("bench-" + std::to_string(t), attrs);
+    qurls.push_back(sqs.create_queue(&create).value());
+  }
+
+  auto handle = [&sqs, &serde](const std::string& qurl) {
+    json send_req = {{"QueueUrl", qurl}, {"MessageBody", BODY}};
+    json receive_req = {{"QueueUrl", qurl}, {"MaxNumberOfMessages", 1}};
+    for (int i = 0; i < REQUESTS_PER_THREAD; i += 3) {
+      auto str = send_req.dump();
+      auto send = serde.deserialize_send_message_input(str).value();
+      auto sent = sqs.send_message(send.get()).second;
+      serde.serialize(sent.get());
+
+      str = receive_req.dump();
+      auto receive = serde.deserialize_receive_message_input(str).value();
+      ReceivedMessagesResponse res;
+      for (auto& msg : sqs.receive(receive.get())) {
+        res.messages.push_back(ReceivedMessageResponse{
+            format_uuid(msg.message_id), format_uuid(msg.receipt_handle),
+            format_digest(msg.md5_of_body), msg.body, msg.receive_count});
+      }
+      serde.serialize(&res);
+
+      for (auto& msg : res.messages) {
+        json delete_req = {{"QueueUrl", qurl},
+                           {"ReceiptHandle", msg.receipt_handle}};
+        str = delete_req.dump();
+        auto del = serde.deserialize_delete_message_input(str).value();
+        sqs.delete_message(del.get());
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back(handle, qurls[t]);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return threads * REQUESTS_PER_THREAD /
+         std::chrono::duration<double>(elapsed).count();
+}
+
+auto main() -> int {
+  int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "threads\treq/s\t\tspeedup\tone queue\tstriped\t\tgain"
+            << std::endl;
+  double base = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    auto rate = throughput(threads);
+    if (threads == 1) {
+      base = rate;
+    }
+    // the gain of striping the one queue all threads share
+    auto one_queue = throughput(threads, 1);
+    auto striped = throughput(threads, threads);
+    std::cout << threads << "\t" << (long)rate << "\t\t" << rate / base
+              << "\t" << (long)one_queue << "\t\t" << (long)striped
+              << "\t\t" << striped / one_queue << std::endl;
+  }
+  return 0;
+}
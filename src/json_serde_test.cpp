@@ -96,12 +96,44 @@ TEST(json_serde_test, create_queue_response_to_str) {
 TEST(json_serde_test, list_queues_response_to_str) {
   JsonSerde serde;
   ListQueuesResponse res;
-  std::vector<QueueInfo> qs = {QueueInfo{"foo", "foo", 0},
-                               QueueInfo{"bar", "bar", 1}};
-  res.queue_urls = &qs;
+  res.queues = {QueueInfo{"foo", "foo"}, QueueInfo{"bar", "bar"}};
   auto str = serde.serialize(&res);
 
   EXPECT_EQ(str, "{\"QueueUrls\":[\"foo\",\"bar\"]}");
+
+  res.next_token = "bar";
+  str = serde.serialize(&res);
+  EXPECT_EQ(str, "{\"NextToken\":\"bar\",\"QueueUrls\":[\"foo\",\"bar\"]}");
+}
+
+TEST(json_serde_test, list_queues_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueNamePrefix\":\"orders-\",\"MaxResults\":10,"
+      "\"NextToken\":\"orders-7\"}";
+  auto res = serde.deserialize_list_queues_input(input).value();
+  EXPECT_EQ(res->get_queue_name_prefix().value(), "orders-");
+  EXPECT_EQ(res->get_max_results().value(), 10);
+  EXPECT_EQ(res->get_next_token().value(), "orders-7");
+  EXPECT_FALSE(res->get_message_counts());
+
+  std::string empty = "";
+  res = serde.deserialize_list_queues_input(empty).value();
+  EXPECT_FALSE(res->get_queue_name_prefix().has_value());
+  EXPECT_FALSE(res->get_max_results().has_value());
+}
+
+TEST(json_serde_test, list_queues_input_saturates_max_results) {
+  JsonSerde serde;
+  // wrapped into int, this would be a valid MaxResults of 1
+  std::string input = "{\"MaxResults\":4294967297}";
+  auto res = serde.deserialize_list_queues_input(input).value();
+  EXPECT_EQ(res->get_max_results(), std::numeric_limits<int>::max());
+
+  input = "{\"SourceArn\":\"arn:aws:sqs:us-east-1:000000000000:dlq\","
+          "\"MaxResults\":4294967297}";
+  auto tasks = serde.deserialize_list_message_move_tasks_input(input).value();
+  EXPECT_EQ(tasks->get_max_results(), std::numeric_limits<int>::max());
 }
 
 TEST(json_serde_test, delete_queue_input_from_str) {
@@ -190,11 +222,26 @@ TEST(json_serde_test, receive_message_input_from_str) {
   EXPECT_EQ(res.value()->get_max_number_of_messages(), 1);
 }
 
+TEST(json_serde_test, receive_message_input_saturates_out_of_range_ints) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"MaxNumberOfMessages\":4294967297,"
+      "\"VisibilityTimeout\":-4294967296,"
+      "\"WaitTimeSeconds\":18446744073709551615}";
+  auto res = serde.deserialize_receive_message_input(input).value();
+
+  // wrapped, they would fall back into the valid ranges
+  EXPECT_EQ(res->get_max_number_of_messages(),
+            std::numeric_limits<int>::max());
+  EXPECT_EQ(res->get_visibility_timeout(), std::numeric_limits<int>::min());
+  EXPECT_EQ(res->get_wait_time_seconds(), std::numeric_limits<long>::max());
+}
+
 TEST(json_serde_test, received_message_response_to_str) {
   JsonSerde serde;
   ReceivedMessageResponse res;
   res.message_id = "test-id";
-  res.body = "test-body";
+  res.body = Body("test-body");
   res.md5_of_body = "test-md5";
   res.receipt_handle = "test-handle";
   auto str = serde.serialize(&res);
@@ -214,3 +261,203 @@ TEST(json_serde_test, delete_message_input_from_str) {
   EXPECT_EQ(res.value()->get_queue_url(), "test-url");
   EXPECT_EQ(res.value()->get_receipt_handle(), "test-handle");
 }
+
+TEST(json_serde_test, set_queue_attributes_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"Attributes\":{\"DelaySeconds\":\"5\"}}";
+  auto res = serde.deserialize_set_queue_attributes_input(input);
+
+  EXPECT_EQ(res.has_value(), true);
+  EXPECT_EQ(res.value()->get_queue_url(), "test-url");
+  EXPECT_EQ(res.value()->get_attrs().at("DelaySeconds"), "5");
+}
+
+TEST(json_serde_test, get_queue_attributes_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"AttributeNames\":[\"All\"]}";
+  auto res = serde.deserialize_get_queue_attributes_input(input);
+
+  EXPECT_EQ(res.has_value(), true);
+  EXPECT_EQ(res.value()->get_queue_url(), "test-url");
+  EXPECT_EQ(res.value()->get_attribute_names().at(0), "All");
+}
+
+TEST(json_serde_test, get_queue_attributes_response_to_str) {
+  JsonSerde serde;
+  GetQueueAttributesResponse res;
+  std::map<std::string, std::string> attrs = {{"DelaySeconds", "5"}};
+  res.attributes = &attrs;
+  auto str = serde.serialize(&res);
+
+  EXPECT_EQ(str, "{\"Attributes\":{\"DelaySeconds\":\"5\"}}");
+}
+
+TEST(json_serde_test, received_messages_response_to_str) {
+  JsonSerde serde;
+  std::string body = "{\"key\":\"a\\b\"}\n\t\x01 zażółć";
+  ReceivedMessagesResponse res;
+  res.messages.push_back(ReceivedMessageResponse{
+      "test-id", "test-handle", "test-md5",
+      Body(body)});
+  res.messages.push_back(ReceivedMessageResponse{
+      "other-id", "other-handle", "other-md5",
+      Body("other-body")});
+  auto str = serde.serialize(&res);
+
+  json expected;
+  expected["Messages"] = {
+      {{"MessageId", "test-id"},
+       {"ReceiptHandle", "test-handle"},
+       {"MD5OfBody", "test-md5"},
+       {"Body", body}},
+      {{"MessageId", "other-id"},
+       {"ReceiptHandle", "other-handle"},
+       {"MD5OfBody", "other-md5"},
+       {"Body", "other-body"}}};
+  EXPECT_EQ(str, expected.dump());
+}
+
+TEST(json_serde_test, received_messages_response_with_receive_count_to_str) {
+  JsonSerde serde;
+  ReceivedMessagesResponse res;
+  res.messages.push_back(ReceivedMessageResponse{
+      "test-id", "test-handle", "test-md5", Body("test-body"), 2});
+  auto str = serde.serialize(&res);
+
+  json expected;
+  expected["Messages"] = {{{"Attributes", {{"ApproximateReceiveCount", "2"}}},
+                           {"MessageId", "test-id"},
+                           {"ReceiptHandle", "test-handle"},
+                           {"MD5OfBody", "test-md5"},
+                           {"Body", "test-body"}}};
+  EXPECT_EQ(str, expected.dump());
+}
+
+TEST(json_serde_test, received_messages_response_to_str_empty) {
+  JsonSerde serde;
+  ReceivedMessagesResponse res;
+  auto str = serde.serialize(&res);
+
+  EXPECT_EQ(str, "{\"Messages\":[]}");
+}
+
+TEST(json_serde_test, change_message_visibility_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"ReceiptHandle\":\"test-handle\","
+      "\"VisibilityTimeout\":60}";
+  auto res = serde.deserialize_change_message_visibility_input(input);
+
+  ASSERT_EQ(res.has_value(), true);
+  EXPECT_EQ(res.value()->get_queue_url(), "test-url");
+  EXPECT_EQ(res.value()->get_receipt_handle(), "test-handle");
+  EXPECT_EQ(res.value()->get_visibility_timeout(), 60);
+}
+
+TEST(json_serde_test, send_message_batch_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"Entries\":["
+      "{\"Id\":\"a\",\"MessageBody\":\"one\",\"DelaySeconds\":5},"
+      "{\"Id\":\"b\",\"MessageBody\":\"two\"}]}";
+  auto res = serde.deserialize_send_message_batch_input(input);
+
+  ASSERT_EQ(res.has_value(), true);
+  auto& entries = res.value()->get_entries();
+  ASSERT_EQ(entries.size(), 2);
+  EXPECT_EQ(entries[0].id, "a");
+  EXPECT_EQ(entries[0].message_body, "one");
+  EXPECT_EQ(entries[0].delay_seconds, 5);
+  EXPECT_EQ(entries[1].delay_seconds.has_value(), false);
+}
+
+TEST(json_serde_test, send_message_batch_input_from_str_bad_entry) {
+  JsonSerde serde;
+  std::string input = "{\"QueueUrl\":\"test-url\",\"Entries\":[1]}";
+  auto res = serde.deserialize_send_message_batch_input(input);
+
+  EXPECT_EQ(res.has_value(), false);
+}
+
+TEST(json_serde_test, change_message_visibility_batch_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"QueueUrl\":\"test-url\",\"Entries\":[{\"Id\":\"a\","
+      "\"ReceiptHandle\":\"test-handle\",\"VisibilityTimeout\":0}]}";
+  auto res = serde.deserialize_change_message_visibility_batch_input(input);
+
+  ASSERT_EQ(res.has_value(), true);
+  auto& entries = res.value()->get_entries();
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].receipt_handle, "test-handle");
+  EXPECT_EQ(entries[0].visibility_timeout, 0);
+}
+
+TEST(json_serde_test, batch_response_to_str) {
+  JsonSerde serde;
+  BatchResponse res;
+  res.successful.push_back("a");
+  res.failed.push_back(
+      BatchResultErrorEntry{"b", true, "ReceiptHandleIsInvalid", "invalid"});
+  auto str = serde.serialize(&res);
+
+  EXPECT_EQ(str,
+            "{\"Failed\":[{\"Code\":\"ReceiptHandleIsInvalid\",\"Id\":"
+            "\"b\",\"Message\":\"invalid\",\"SenderFault\":true}],"
+            "\"Successful\":[{\"Id\":\"a\"}]}");
+}
+
+TEST(json_serde_test, list_dead_letter_source_queues_response_to_str) {
+  JsonSerde serde;
+  ListDeadLetterSourceQueuesResponse res{{"url-a", "url-b"}};
+  auto str = serde.serialize(&res);
+
+  EXPECT_EQ(str, "{\"queueUrls\":[\"url-a\",\"url-b\"]}");
+}
+
+TEST(json_serde_test, start_message_move_task_input_from_str) {
+  JsonSerde serde;
+  std::string input =
+      "{\"SourceArn\":\"arn:aws:sqs:us-east-1:000000000000:dlq\","
+      "\"MaxNumberOfMessagesPerSecond\":50}";
+  auto res = serde.deserialize_start_message_move_task_input(input);
+
+  ASSERT_EQ(res.has_value(), true);
+  EXPECT_EQ(res.value()->get_source_arn(),
+            "arn:aws:sqs:us-east-1:000000000000:dlq");
+  EXPECT_FALSE(res.value()->get_destination_arn().has_value());
+  EXPECT_EQ(res.value()->get_max_number_of_messages_per_second(), 50);
+}
+
+TEST(json_serde_test, list_message_move_tasks_response_to_str) {
+  JsonSerde serde;
+  ListMessageMoveTasksResponse res;
+  res.results.push_back(MessageMoveTaskResult{
+      "", "COMPLETED", "arn:dlq", "arn:src", {}, 5, 5, "", 1000});
+  auto str = serde.serialize(&res);
+
+  json expected;
+  expected["Results"] = {{{"Status", "COMPLETED"},
+                          {"SourceArn", "arn:dlq"},
+                          {"DestinationArn", "arn:src"},
+                          {"ApproximateNumberOfMessagesMoved", 5},
+                          {"ApproximateNumberOfMessagesToMove", 5},
+                          {"StartedTimestamp", 1000}}};
+  EXPECT_EQ(str, expected.dump());
+}
+
+TEST(json_serde_test, read_string_member) {
+  JsonSerde serde;
+  std::string body =
+      "{\"Attributes\":{\"QueueUrl\":\"nested\"},\"Tags\":[\"QueueUrl\"],"
+      "\"QueueUrl\":\"http://localhost/1/test\",\"Broken\":";
+  EXPECT_EQ(serde.read_string_member(body, "QueueUrl"),
+            "http://localhost/1/test");
+
+  body = "{\"QueueUrl\":5,\"Attributes\":{\"QueueUrl\":\"nested\"}}";
+  EXPECT_FALSE(serde.read_string_member(body, "QueueUrl").has_value());
+  body = "";
+  EXPECT_FALSE(serde.read_string_member(body, "QueueUrl").has_value());
+}
@@ -0,0 +1,80 @@
+#include "mailbox.hpp"
+
+#include <thread>
+
+namespace sqscpp {
+Mailbox::Mailbox(std::function<void()> wake)
+    : head(&stub), tail(&stub), pending(0), wake(std::move(wake)) {}
+
+Mailbox::~Mailbox() {
+  Node* node;
+  while ((node = pop()) != nullptr) {
+    delete node;
+  }
+}
+
+void Mailbox::push(Node* node) {
+  node->next.store(nullptr, std::memory_order_relaxed);
+  auto prev = head.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+Mailbox::Node* Mailbox::pop() {
+  auto node = tail;
+  auto next = node->next.load(std::memory_order_acquire);
+  if (node == &stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    tail = next;
+    node = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next != nullptr) {
+    tail = next;
+    return node;
+  }
+  if (node != head.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  // `node` is the last one, the stub goes behind it so that it can be
+  // popped without leaving the list empty
+  push(&stub);
+  next = node->next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    tail = next;
+    return node;
+  }
+  return nullptr;
+}
+
+void Mailbox::post(std::function<void()> task) {
+  auto node = new Node();
+  node->task = std::move(task);
+  push(node);
+  if (pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+    wake();
+  }
+}
+
+size_t Mailbox::drain() {
+  size_t ran = 0;
+  auto due = pending.load(std::memory_order_acquire);
+  while (due > 0) {
+    for (size_t i = 0; i < due; i++) {
+      Node* node;
+      // a post counted already may still be linking an earlier node in
+      while ((node = pop()) == nullptr) {
+        std::this_thread::yield();
+      }
+      node->task();
+      delete node;
+    }
+    ran += due;
+    // posts that came in meanwhile found the mailbox busy and did not wake
+    // the shard again
+    due = pending.fetch_sub(due, std::memory_order_acq_rel) - due;
+  }
+  return ran;
+}
+}  // namespace sqscpp
@@ -0,0 +1,48 @@
+#ifndef SQSCPP_MAILBOX_H
+#define SQSCPP_MAILBOX_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace sqscpp {
+// Tasks posted to a shard by the others. Any thread may post, only the
+// owning shard drains. Posting takes no lock, it links the task in with an
+// atomic exchange, and calls `wake` only when the mailbox was empty, so a
+// burst of posts costs the shard a single wake up.
+class Mailbox {
+ private:
+  struct Node {
+    std::function<void()> task;
+    std::atomic<Node*> next = nullptr;
+  };
+
+  // producers append at `head`, the shard pops at `tail`, `stub` keeps the
+  // list from running empty
+  std::atomic<Node*> head;
+  Node* tail;
+  Node stub;
+  // tasks posted and not run yet
+  std::atomic<size_t> pending;
+  std::function<void()> wake;
+
+  void push(Node* node);
+  // nothing when the list is empty or a post is halfway through linking
+  Node* pop();
+
+ public:
+  // `wake` has to make the shard call drain soon, it runs on the posting
+  // thread.
+  explicit Mailbox(std::function<void()> wake);
+  ~Mailbox();
+  Mailbox(const Mailbox&) = delete;
+  Mailbox& operator=(const Mailbox&) = delete;
+
+  void post(std::function<void()> task);
+  // Runs the posted tasks in order, including those posted meanwhile, and
+  // returns how many ran.
+  size_t drain();
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_MAILBOX_H
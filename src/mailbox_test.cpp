@@ -0,0 +1,78 @@
+#include "mailbox.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace sqscpp;
+
+TEST(mailbox_test, drain_runs_tasks_in_order) {
+  int wakes = 0;
+  Mailbox mailbox([&wakes]() { wakes++; });
+  std::vector<int> ran;
+  for (int i = 0; i < 3; i++) {
+    mailbox.post([&ran, i]() { ran.push_back(i); });
+  }
+  EXPECT_EQ(wakes, 1);
+  EXPECT_EQ(mailbox.drain(), 3);
+  EXPECT_EQ(ran, (std::vector<int>{0, 1, 2}));
+  EXPECT_EQ(mailbox.drain(), 0);
+
+  // drained, the next post wakes the shard again
+  mailbox.post([&ran]() { ran.push_back(3); });
+  EXPECT_EQ(wakes, 2);
+  EXPECT_EQ(mailbox.drain(), 1);
+}
+
+TEST(mailbox_test, drain_runs_tasks_posted_while_draining) {
+  int wakes = 0;
+  Mailbox mailbox([&wakes]() { wakes++; });
+  int ran = 0;
+  mailbox.post([&]() {
+    ran++;
+    mailbox.post([&ran]() { ran++; });
+  });
+  EXPECT_EQ(mailbox.drain(), 2);
+  EXPECT_EQ(ran, 2);
+  EXPECT_EQ(wakes, 1);
+}
+
+TEST(mailbox_test, concurrent_posts_all_run) {
+  const int PRODUCERS = 4;
+  const int TASKS = 20000;
+  std::atomic<int> wakes = 0;
+  Mailbox mailbox([&wakes]() { wakes++; });
+  // only the draining thread touches `last`
+  std::vector<int> last(PRODUCERS, -1);
+  bool ordered = true;
+
+  std::atomic<bool> done = false;
+  std::thread shard([&]() {
+    size_t ran = 0;
+    while (!done || ran < (size_t)PRODUCERS * TASKS) {
+      ran += mailbox.drain();
+      std::this_thread::yield();
+    }
+  });
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; p++) {
+    producers.emplace_back([&, p]() {
+      for (int i = 0; i < TASKS; i++) {
+        mailbox.post([&, p, i]() {
+          ordered &= last[p] == i - 1;
+          last[p] = i;
+        });
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done = true;
+  shard.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(last, std::vector<int>(PRODUCERS, TASKS - 1));
+  EXPECT_LE(wakes, PRODUCERS * TASKS);
+}
@@ -1,5 +1,11 @@
+#include <sys/socket.h>
+
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <restinio/core.hpp>
+#include <thread>
+#include <vector>
 
 #include "cli_args.hpp"
 #include "router.hpp"
@@ -9,24 +15,117 @@ auto main(int argc, char *argv[]) -> int {
   if (!args_res.first) return EXIT_FAILURE;
   auto args = args_res.second;
 
-  std::cout << "Starting sqscpp " << args.host << ":" << args.port << std::endl;
+  std::cout << "Starting sqscpp " << args.host << ":" << args.port << " with "
+            << args.threads << " thread(s) and " << args.shards << " shard(s)"
+            << std::endl;
 
   using namespace std::chrono;
 
   try {
-    using traits_t =
-        restinio::traits_t<restinio::asio_timer_manager_t,
-                           restinio::single_threaded_ostream_logger_t>;
-
-    auto sqs = sqscpp::SQS(endpoint_url(&args));
     auto json_serde = sqscpp::JsonSerde();
+    auto cbor_serde = sqscpp::CborSerde();
     auto html_serde = sqscpp::HtmlSerde();
 
-    restinio::run(restinio::on_this_thread<traits_t>()
-                      .port(args.port)
-                      .address(args.host)
-                      .request_handler(sqscpp::handler_factory(
-                          &sqs, &json_serde, &html_serde)));
+    auto configure = [&](auto &&settings, auto handler) {
+      return std::move(settings.port(args.port)
+                           .address(args.host)
+                           // long polling receives are answered after up to
+                           // MAX_WAIT_TIME_SECONDS
+                           .handle_request_timeout(seconds(
+                               sqscpp::MAX_WAIT_TIME_SECONDS + 10))
+                           .request_handler(std::move(handler)));
+    };
+
+    if (args.shards > 1) {
+      // every shard is a reactor of its own on a dedicated thread, binding
+      // the same address with SO_REUSEPORT so that the kernel spreads
+      // connections over their listeners. A shard owns the queues shard_of
+      // assigns it and gets the requests for them other shards accepted
+      // through its mailbox.
+      using traits_t =
+          restinio::traits_t<restinio::asio_timer_manager_t,
+                             restinio::shared_ostream_logger_t>;
+      using reuse_port =
+          restinio::asio_ns::detail::socket_option::boolean<SOL_SOCKET,
+                                                            SO_REUSEPORT>;
+      // the instances post to the mailboxes from their schedulers, so they
+      // are destroyed first
+      std::vector<std::unique_ptr<restinio::asio_ns::io_context>> contexts;
+      std::vector<std::unique_ptr<sqscpp::Mailbox>> mailboxes;
+      std::vector<std::unique_ptr<sqscpp::SQS>> instances;
+      for (int i = 0; i < args.shards; i++) {
+        instances.push_back(
+            std::make_unique<sqscpp::SQS>(endpoint_url(&args)));
+        contexts.push_back(std::make_unique<restinio::asio_ns::io_context>());
+        auto context = contexts.back().get();
+        mailboxes.push_back(
+            std::make_unique<sqscpp::Mailbox>([context, i, &mailboxes]() {
+              restinio::asio_ns::post(
+                  *context, [i, &mailboxes]() { mailboxes[i]->drain(); });
+            }));
+      }
+      std::vector<sqscpp::Shard> shards;
+      for (int i = 0; i < args.shards; i++) {
+        shards.push_back(
+            sqscpp::Shard{instances[i].get(), mailboxes[i].get()});
+      }
+      for (int i = 0; i < args.shards; i++) {
+        instances[i]->join_shards(shards, i);
+      }
+
+      std::atomic<bool> failed = false;
+      {
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < args.shards; i++) {
+          threads.emplace_back([&, i]() {
+            try {
+              restinio::run(
+                  *contexts[i],
+                  configure(
+                      restinio::on_this_thread<traits_t>()
+                          .acceptor_options_setter(
+                              [](restinio::acceptor_options_t &options) {
+                                options.set_option(
+                                    restinio::asio_ns::ip::tcp::acceptor::
+                                        reuse_address(true));
+                                options.set_option(reuse_port(true));
+                              }),
+                      sqscpp::shard_handler_factory(&shards, i, &json_serde,
+                                                    &cbor_serde,
+                                                    &html_serde)));
+            } catch (const std::exception &ex) {
+              std::cerr << "ERR: shard " << i << ": " << ex.what()
+                        << std::endl;
+              // the others would be left answering for queues nobody owns
+              failed = true;
+              for (auto &context : contexts) {
+                context->stop();
+              }
+            }
+          });
+        }
+      }
+      if (failed) return EXIT_FAILURE;
+    } else {
+      auto sqs = sqscpp::SQS(endpoint_url(&args));
+      auto handler = sqscpp::handler_factory(&sqs, &json_serde, &cbor_serde,
+                                             &html_serde);
+      if (args.threads == 1) {
+        using traits_t =
+            restinio::traits_t<restinio::asio_timer_manager_t,
+                               restinio::single_threaded_ostream_logger_t>;
+        restinio::run(
+            configure(restinio::on_this_thread<traits_t>(), handler));
+      } else {
+        // handlers run concurrently, the default strand serialises the work
+        // of each connection, including responses sent from other threads
+        using traits_t =
+            restinio::traits_t<restinio::asio_timer_manager_t,
+                               restinio::shared_ostream_logger_t>;
+        restinio::run(configure(
+            restinio::on_thread_pool<traits_t>(args.threads), handler));
+      }
+    }
   } catch (const std::exception &ex) {
     std::cerr << "ERR: " << ex.what() << std::endl;
     return EXIT_FAILURE;
@@ -0,0 +1,60 @@
+#include "message.hpp"
+
+#include <boost/uuid/uuid_io.hpp>
+
+namespace sqscpp {
+Body::Body(std::string content) : length(content.size()) {
+  auto owner = std::make_shared<const std::string>(std::move(content));
+  bytes = std::shared_ptr<const char>(owner, owner->data());
+}
+
+std::string format_uuid(const boost::uuids::uuid& id) {
+  if (id.is_nil()) {
+    return "";
+  }
+  return boost::uuids::to_string(id);
+}
+
+std::string format_digest(const Digest& digest) {
+  static const char* HEX = "0123456789abcdef";
+  std::string output(digest.size() * 2, '0');
+  for (size_t i = 0; i < digest.size(); i++) {
+    output[i * 2] = HEX[digest[i] >> 4];
+    output[i * 2 + 1] = HEX[digest[i] & 0xf];
+  }
+  return output;
+}
+
+std::optional<boost::uuids::uuid> parse_uuid(const std::string& str) {
+  // canonical 8-4-4-4-12 form only, as produced by format_uuid
+  if (str.size() != 36) {
+    return {};
+  }
+
+  boost::uuids::uuid id;
+  size_t pos = 0;
+  for (size_t i = 0; i < id.size(); i++) {
+    if (pos == 8 || pos == 13 || pos == 18 || pos == 23) {
+      if (str[pos] != '-') return {};
+      pos++;
+    }
+    int byte = 0;
+    for (int j = 0; j < 2; j++, pos++) {
+      auto c = str[pos];
+      int nibble;
+      if (c >= '0' && c <= '9') {
+        nibble = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        nibble = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        nibble = c - 'A' + 10;
+      } else {
+        return {};
+      }
+      byte = byte << 4 | nibble;
+    }
+    id.data[i] = byte;
+  }
+  return id;
+}
+}  // namespace sqscpp
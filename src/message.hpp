@@ -0,0 +1,53 @@
+#ifndef SQSCPP_MESSAGE_H
+#define SQSCPP_MESSAGE_H
+
+#include <array>
+#include <boost/uuid/uuid.hpp>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sqscpp {
+using Digest = std::array<uint8_t, 16>;
+// Immutable, refcounted message body. Bodies are shared by every copy of the
+// message, receive results and responses only take a reference. The bytes
+// either live in their own allocation or in a BodyPool slab.
+class Body {
+ private:
+  std::shared_ptr<const char> bytes;
+  size_t length;
+
+ public:
+  Body() : length(0) {}
+  Body(std::shared_ptr<const char> data, size_t size)
+      : bytes(std::move(data)), length(size) {}
+  explicit Body(std::string content);
+
+  std::string_view view() const { return {bytes.get(), length}; }
+  size_t size() const { return length; }
+};
+
+// Ids and digests are kept in binary and only formatted as text when a
+// response is built.
+struct Message {
+  boost::uuids::uuid message_id;
+  // receipt handle minted by the most recent receive, nil unless in flight
+  boost::uuids::uuid receipt_handle;
+  Digest md5_of_body;
+  long visible_at;
+  Body body;
+  // when the message was sent, or moved to its current queue
+  long sent_at = 0;
+  // ApproximateReceiveCount, kept when the message moves to a dead-letter
+  // queue
+  uint32_t receive_count = 0;
+};
+
+std::string format_uuid(const boost::uuids::uuid& id);
+std::string format_digest(const Digest& digest);
+std::optional<boost::uuids::uuid> parse_uuid(const std::string& str);
+}  // namespace sqscpp
+
+#endif  // SQSCPP_MESSAGE_H
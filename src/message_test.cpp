@@ -0,0 +1,34 @@
+#include "message.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/uuid/uuid_generators.hpp>
+
+using namespace sqscpp;
+
+TEST(message_test, format_and_parse_uuid) {
+  boost::uuids::random_generator gen;
+  auto id = gen();
+  auto str = format_uuid(id);
+
+  EXPECT_EQ(str.size(), 36);
+  EXPECT_EQ(parse_uuid(str).value(), id);
+}
+
+TEST(message_test, format_nil_uuid) {
+  EXPECT_EQ(format_uuid(boost::uuids::nil_uuid()), "");
+}
+
+TEST(message_test, parse_uuid_rejects_malformed) {
+  EXPECT_FALSE(parse_uuid("").has_value());
+  EXPECT_FALSE(parse_uuid("not-a-receipt-handle").has_value());
+  EXPECT_FALSE(parse_uuid("0123456789abcdef0123456789abcdef0123").has_value());
+  EXPECT_FALSE(parse_uuid("g1234567-89ab-cdef-0123-456789abcdef").has_value());
+}
+
+TEST(message_test, format_digest) {
+  Digest digest = {0x00, 0x01, 0x0a, 0xff, 0x10, 0x20, 0x30, 0x40,
+                   0x50, 0x60, 0x70, 0x80, 0x90, 0xa0, 0xb0, 0xc0};
+
+  EXPECT_EQ(format_digest(digest), "00010aff102030405060708090a0b0c0");
+}
@@ -4,10 +4,15 @@
 #include <restinio/core.hpp>
 #include <string>
 
+#include "body_pool.hpp"
+#include "message.hpp"
+
 namespace sqscpp {
 struct Error {
   restinio::http_status_line_t status;
   std::string message;
+  // name of the error shape in the SQS model, like QueueDoesNotExist
+  std::string type;
 };
 
 class CreateQueueInput {
@@ -37,6 +42,29 @@ class GetQueueUrlInput {
   std::string &get_queue_name() { return queue_name; }
 };
 
+class ListQueuesInput {
+ private:
+  std::optional<std::string> queue_name_prefix;
+  std::optional<int> max_results;
+  std::optional<std::string> next_token;
+  bool message_counts;
+
+ public:
+  ListQueuesInput(std::optional<std::string> prefix, std::optional<int> max,
+                  std::optional<std::string> token, bool counts = false)
+      : queue_name_prefix(prefix),
+        max_results(max),
+        next_token(token),
+        message_counts(counts) {}
+  std::optional<std::string> &get_queue_name_prefix() {
+    return queue_name_prefix;
+  }
+  std::optional<int> &get_max_results() { return max_results; }
+  std::optional<std::string> &get_next_token() { return next_token; }
+  // whether the listed queues come with their message counts
+  bool get_message_counts() { return message_counts; }
+};
+
 class DeleteQueueInput {
  private:
   std::string queue_url;
@@ -55,6 +83,15 @@ class PurgeQueueInput {
   std::string &get_queue_url() { return queue_url; }
 };
 
+class ListDeadLetterSourceQueuesInput {
+ private:
+  std::string queue_url;
+
+ public:
+  ListDeadLetterSourceQueuesInput(std::string qurl) : queue_url(qurl) {}
+  std::string &get_queue_url() { return queue_url; }
+};
+
 class TagQueueInput {
  private:
   std::string queue_url;
@@ -88,27 +125,63 @@ class UntagQueueInput {
   std::vector<std::string> &get_tag_keys() { return tag_keys; }
 };
 
+class SetQueueAttributesInput {
+ private:
+  std::string queue_url;
+  std::map<std::string, std::string> attributes;
+
+ public:
+  SetQueueAttributesInput(std::string qurl,
+                          std::map<std::string, std::string> attrs)
+      : queue_url(qurl), attributes(attrs) {}
+  std::string &get_queue_url() { return queue_url; }
+  std::map<std::string, std::string> &get_attrs() { return attributes; }
+};
+
+class GetQueueAttributesInput {
+ private:
+  std::string queue_url;
+  std::vector<std::string> attribute_names;
+
+ public:
+  GetQueueAttributesInput(std::string qurl,
+                          std::optional<std::vector<std::string>> names)
+      : queue_url(qurl) {
+    if (names.has_value()) {
+      attribute_names = names.value();
+    }
+  }
+  std::string &get_queue_url() { return queue_url; }
+  std::vector<std::string> &get_attribute_names() { return attribute_names; }
+};
+
 class SendMessageInput {
  private:
   std::string queue_url;
   std::string message_body;
   std::optional<long> delay_seconds;
   std::optional<std::string> message_deduplication_id;
+  std::optional<std::string> message_group_id;
 
  public:
   SendMessageInput(std::string qurl, std::string body,
                    std::optional<long> delay,
-                   std::optional<std::string> deduplication_id)
+                   std::optional<std::string> deduplication_id,
+                   std::optional<std::string> group_id = {})
       : queue_url(qurl),
-        message_body(body),
+        message_body(std::move(body)),
         delay_seconds(delay),
-        message_deduplication_id(deduplication_id) {}
+        message_deduplication_id(deduplication_id),
+        message_group_id(group_id) {}
   std::string &get_queue_url() { return queue_url; }
   std::string &get_message_body() { return message_body; }
   std::optional<long> &get_delay_seconds() { return delay_seconds; }
   std::optional<std::string> &get_message_deduplication_id() {
     return message_deduplication_id;
   }
+  std::optional<std::string> &get_message_group_id() {
+    return message_group_id;
+  }
 };
 
 class ReceiveMessageInput {
@@ -153,13 +226,142 @@ class DeleteMessageInput {
   std::string &get_receipt_handle() { return receipt_handle; }
 };
 
+class ChangeMessageVisibilityInput {
+ private:
+  std::string queue_url;
+  std::string receipt_handle;
+  long visibility_timeout;
+
+ public:
+  ChangeMessageVisibilityInput(std::string qurl, std::string rh,
+                               long _visibility_timeout)
+      : queue_url(qurl),
+        receipt_handle(rh),
+        visibility_timeout(_visibility_timeout) {}
+  std::string &get_queue_url() { return queue_url; }
+  std::string &get_receipt_handle() { return receipt_handle; }
+  long get_visibility_timeout() { return visibility_timeout; }
+};
+
+struct SendMessageBatchEntry {
+  std::string id;
+  std::string message_body;
+  std::optional<long> delay_seconds;
+  std::optional<std::string> message_deduplication_id;
+  std::optional<std::string> message_group_id;
+};
+
+class SendMessageBatchInput {
+ private:
+  std::string queue_url;
+  std::vector<SendMessageBatchEntry> entries;
+
+ public:
+  SendMessageBatchInput(std::string qurl,
+                        std::vector<SendMessageBatchEntry> _entries)
+      : queue_url(qurl), entries(std::move(_entries)) {}
+  std::string &get_queue_url() { return queue_url; }
+  std::vector<SendMessageBatchEntry> &get_entries() { return entries; }
+};
+
+struct DeleteMessageBatchEntry {
+  std::string id;
+  std::string receipt_handle;
+};
+
+class DeleteMessageBatchInput {
+ private:
+  std::string queue_url;
+  std::vector<DeleteMessageBatchEntry> entries;
+
+ public:
+  DeleteMessageBatchInput(std::string qurl,
+                          std::vector<DeleteMessageBatchEntry> _entries)
+      : queue_url(qurl), entries(std::move(_entries)) {}
+  std::string &get_queue_url() { return queue_url; }
+  std::vector<DeleteMessageBatchEntry> &get_entries() { return entries; }
+};
+
+struct ChangeMessageVisibilityBatchEntry {
+  std::string id;
+  std::string receipt_handle;
+  long visibility_timeout;
+};
+
+class ChangeMessageVisibilityBatchInput {
+ private:
+  std::string queue_url;
+  std::vector<ChangeMessageVisibilityBatchEntry> entries;
+
+ public:
+  ChangeMessageVisibilityBatchInput(
+      std::string qurl, std::vector<ChangeMessageVisibilityBatchEntry> _entries)
+      : queue_url(qurl), entries(std::move(_entries)) {}
+  std::string &get_queue_url() { return queue_url; }
+  std::vector<ChangeMessageVisibilityBatchEntry> &get_entries() {
+    return entries;
+  }
+};
+
+class StartMessageMoveTaskInput {
+ private:
+  std::string source_arn;
+  std::optional<std::string> destination_arn;
+  std::optional<long> max_number_of_messages_per_second;
+
+ public:
+  StartMessageMoveTaskInput(std::string source,
+                            std::optional<std::string> destination,
+                            std::optional<long> max_per_second)
+      : source_arn(source),
+        destination_arn(destination),
+        max_number_of_messages_per_second(max_per_second) {}
+  std::string &get_source_arn() { return source_arn; }
+  std::optional<std::string> &get_destination_arn() { return destination_arn; }
+  std::optional<long> &get_max_number_of_messages_per_second() {
+    return max_number_of_messages_per_second;
+  }
+};
+
+class CancelMessageMoveTaskInput {
+ private:
+  std::string task_handle;
+
+ public:
+  CancelMessageMoveTaskInput(std::string handle) : task_handle(handle) {}
+  std::string &get_task_handle() { return task_handle; }
+};
+
+class ListMessageMoveTasksInput {
+ private:
+  std::string source_arn;
+  std::optional<int> max_results;
+
+ public:
+  ListMessageMoveTasksInput(std::string source, std::optional<int> max)
+      : source_arn(source), max_results(max) {}
+  std::string &get_source_arn() { return source_arn; }
+  std::optional<int> &get_max_results() { return max_results; }
+};
+
 struct BadRequestError : Error {
-  BadRequestError(std::string msg) {
+  BadRequestError(std::string msg,
+                  std::string error_type = "InvalidParameterValue") {
     status = restinio::status_bad_request();
     message = msg;
+    type = error_type;
   }
 };
 
+struct QueueDoesNotExistError : BadRequestError {
+  QueueDoesNotExistError()
+      : BadRequestError("The specified queue does not exist.",
+                        "QueueDoesNotExist") {}
+};
+
+// Result of the actions that return nothing but success.
+struct EmptyResponse {};
+
 struct CreateQueueResponse {
   std::string queue_url;
 };
@@ -167,11 +369,45 @@ struct CreateQueueResponse {
 struct QueueInfo {
   std::string queue_url;
   std::string queue_name;
-  int message_count;
+  // only looked up when the input asks for it
+  std::optional<int> message_count;
 };
 
 struct ListQueuesResponse {
-  std::vector<QueueInfo> *queue_urls;
+  std::vector<QueueInfo> queues;
+  std::optional<std::string> next_token;
+  size_t pending_reclamation_bytes;
+};
+
+struct ListDeadLetterSourceQueuesResponse {
+  std::vector<std::string> queue_urls;
+};
+
+struct StartMessageMoveTaskResponse {
+  std::string task_handle;
+};
+
+struct CancelMessageMoveTaskResponse {
+  long approximate_number_of_messages_moved;
+};
+
+struct MessageMoveTaskResult {
+  // only set while the task is running
+  std::string task_handle;
+  // RUNNING, COMPLETED, CANCELLED or FAILED
+  std::string status;
+  std::string source_arn;
+  std::string destination_arn;
+  std::optional<long> max_number_of_messages_per_second;
+  long approximate_number_of_messages_moved;
+  long approximate_number_of_messages_to_move;
+  std::string failure_reason;
+  // milliseconds since the epoch
+  long started_timestamp;
+};
+
+struct ListMessageMoveTasksResponse {
+  std::vector<MessageMoveTaskResult> results;
 };
 
 struct GetQueueUrlResponse {
@@ -182,11 +418,17 @@ struct ListQueueTagsResponse {
   std::map<std::string, std::string> *tags;
 };
 
+struct GetQueueAttributesResponse {
+  std::map<std::string, std::string> *attributes;
+};
+
 struct ReceivedMessageResponse {
   std::string message_id;
   std::string receipt_handle;
   std::string md5_of_body;
-  std::string body;
+  Body body;
+  // ApproximateReceiveCount, not reported when 0
+  uint32_t receive_count = 0;
 };
 
 struct ReceivedMessagesResponse {
@@ -198,12 +440,38 @@ struct SendMessageResponse {
   std::string md5_of_message_body;
 };
 
+struct BatchResultErrorEntry {
+  std::string id;
+  bool sender_fault;
+  std::string code;
+  std::string message;
+};
+
+struct SendMessageBatchResultEntry {
+  std::string id;
+  std::string message_id;
+  std::string md5_of_message_body;
+};
+
+struct SendMessageBatchResponse {
+  std::vector<SendMessageBatchResultEntry> successful;
+  std::vector<BatchResultErrorEntry> failed;
+};
+
+// Result of a batch whose successful entries carry nothing but their id,
+// DeleteMessageBatch and ChangeMessageVisibilityBatch.
+struct BatchResponse {
+  std::vector<std::string> successful;
+  std::vector<BatchResultErrorEntry> failed;
+};
+
 struct FullQueueDataResponse {
   std::string queue_url;
   std::string queue_name;
   std::vector<ReceivedMessageResponse> messages;
   std::map<std::string, std::string> tags;
   std::map<std::string, std::string> attributes;
+  BodyPoolStats body_pool_stats;
 };
 
 }  // namespace sqscpp
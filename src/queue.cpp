@@ -0,0 +1,450 @@
+#include "queue.hpp"
+
+namespace sqscpp {
+Queue::Queue() : next_seq(0), body_bytes(0) {}
+
+void Queue::tag_receipts(uint8_t tag) { receipt_tag = tag; }
+
+uint32_t Queue::alloc_slot(Message msg, const std::string& group_id) {
+  body_bytes += msg.body.size();
+  auto group = group_id.empty() ? NO_GROUP : find_group(group_id);
+  if (group != NO_GROUP) {
+    groups[group].size++;
+  }
+
+  auto slot = Slot{std::move(msg), NOT_IN_FLIGHT, group, SlotLinks(),
+                   SlotLinks(), next_seq++, true};
+  if (free_slots.empty()) {
+    slots.push_back(std::move(slot));
+    return slots.size() - 1;
+  }
+
+  auto idx = free_slots.back();
+  free_slots.pop_back();
+  slots[idx] = std::move(slot);
+  return idx;
+}
+
+void Queue::free_slot(uint32_t slot) {
+  auto group = slots[slot].group;
+  body_bytes -= slots[slot].message.body.size();
+  if (slots[slot].arrival.prev != NO_SLOT || arrivals.head == slot) {
+    unlink(arrivals, &Slot::arrival, slot);
+  }
+  slots[slot] = Slot{Message(), NOT_IN_FLIGHT, NO_GROUP, SlotLinks(),
+                     SlotLinks(), 0, false};
+  free_slots.push_back(slot);
+  if (group != NO_GROUP) {
+    groups[group].size--;
+    settle_group(group);
+  }
+}
+
+void Queue::link_after(SlotList& list, SlotLinks Slot::*links, uint32_t after,
+                       uint32_t slot) {
+  auto& link = slots[slot].*links;
+  link.prev = after;
+  link.next = after == NO_SLOT ? list.head : (slots[after].*links).next;
+  if (link.next == NO_SLOT) {
+    list.tail = slot;
+  } else {
+    (slots[link.next].*links).prev = slot;
+  }
+  if (after == NO_SLOT) {
+    list.head = slot;
+  } else {
+    (slots[after].*links).next = slot;
+  }
+}
+
+void Queue::unlink(SlotList& list, SlotLinks Slot::*links, uint32_t slot) {
+  auto& link = slots[slot].*links;
+  if (link.prev == NO_SLOT) {
+    list.head = link.next;
+  } else {
+    (slots[link.prev].*links).next = link.next;
+  }
+  if (link.next == NO_SLOT) {
+    list.tail = link.prev;
+  } else {
+    (slots[link.next].*links).prev = link.prev;
+  }
+  link = SlotLinks();
+}
+
+SlotList& Queue::visible_list(uint32_t slot) {
+  auto group = slots[slot].group;
+  return group == NO_GROUP ? ready : groups[group].visible;
+}
+
+uint32_t Queue::find_group(const std::string& group_id) {
+  auto it = group_ids.find(group_id);
+  if (it != group_ids.end()) {
+    return it->second;
+  }
+
+  auto group = MessageGroup{group_id, SlotList(), 0, 0, false};
+  uint32_t idx = groups.size();
+  if (free_groups.empty()) {
+    groups.push_back(std::move(group));
+  } else {
+    idx = free_groups.back();
+    free_groups.pop_back();
+    groups[idx] = std::move(group);
+  }
+  group_ids.emplace(group_id, idx);
+  return idx;
+}
+
+void Queue::settle_group(uint32_t idx) {
+  auto& group = groups[idx];
+  if (group.queued) {
+    return;
+  }
+  if (group.size == 0) {
+    group_ids.erase(group.id);
+    group = MessageGroup{"", SlotList(), 0, 0, false};
+    free_groups.push_back(idx);
+  } else if (group.in_flight == 0 && group.visible.head != NO_SLOT) {
+    group.queued = true;
+    ready_groups.push_back(idx);
+  }
+}
+
+void Queue::make_visible(uint32_t idx) {
+  auto group = slots[idx].group;
+  if (group == NO_GROUP) {
+    link_after(ready, &Slot::visible, ready.tail, idx);
+    return;
+  }
+
+  // messages rejoin their group in send order, returning ones are usually
+  // the oldest and delayed ones the newest
+  auto& list = groups[group].visible;
+  auto seq = slots[idx].seq;
+  if (list.head == NO_SLOT || slots[list.head].seq > seq) {
+    link_after(list, &Slot::visible, NO_SLOT, idx);
+  } else {
+    auto prev = list.tail;
+    while (slots[prev].seq > seq) {
+      prev = slots[prev].visible.prev;
+    }
+    link_after(list, &Slot::visible, prev, idx);
+  }
+  settle_group(group);
+}
+
+void Queue::leave_in_flight(uint32_t idx) {
+  auto group = slots[idx].group;
+  if (group != NO_GROUP) {
+    groups[group].in_flight--;
+    settle_group(group);
+  }
+}
+
+void Queue::push(Message msg, const std::string& group_id) {
+  auto idx = alloc_slot(std::move(msg), group_id);
+  link_after(arrivals, &Slot::arrival, arrivals.tail, idx);
+  make_visible(idx);
+}
+
+void Queue::push_delayed(Message msg, long ts, const std::string& group_id) {
+  auto visible_at = msg.visible_at;
+  delayed.insert(visible_at, alloc_slot(std::move(msg), group_id), ts);
+}
+
+void Queue::heap_set(uint32_t pos, InFlightEntry entry) {
+  in_flight[pos] = entry;
+  slots[entry.slot].heap_pos = pos;
+}
+
+void Queue::heap_push(InFlightEntry entry) {
+  in_flight.push_back(entry);
+  heap_set(in_flight.size() - 1, entry);
+  heap_fix(in_flight.size() - 1);
+}
+
+void Queue::heap_remove(uint32_t pos) {
+  slots[in_flight[pos].slot].heap_pos = NOT_IN_FLIGHT;
+  auto last = in_flight.back();
+  in_flight.pop_back();
+  if (pos < in_flight.size()) {
+    heap_set(pos, last);
+    heap_fix(pos);
+  }
+}
+
+void Queue::heap_fix(uint32_t pos) {
+  auto entry = in_flight[pos];
+  // sift up towards the root while the parent expires later
+  while (pos > 0) {
+    auto parent = (pos - 1) / 2;
+    if (in_flight[parent].visible_at <= entry.visible_at) {
+      break;
+    }
+    heap_set(pos, in_flight[parent]);
+    pos = parent;
+  }
+  // otherwise sift down while a child expires earlier
+  while (true) {
+    auto child = 2 * (size_t)pos + 1;
+    if (child >= in_flight.size()) {
+      break;
+    }
+    if (child + 1 < in_flight.size() &&
+        in_flight[child + 1].visible_at < in_flight[child].visible_at) {
+      child++;
+    }
+    if (entry.visible_at <= in_flight[child].visible_at) {
+      break;
+    }
+    heap_set(pos, in_flight[child]);
+    pos = child;
+  }
+  heap_set(pos, entry);
+}
+
+void Queue::release_expired(long ts) {
+  while (!in_flight.empty() && in_flight.front().visible_at <= ts) {
+    auto idx = in_flight.front().slot;
+    heap_remove(0);
+
+    auto& slot = slots[idx];
+    receipts.erase(slot.message.receipt_handle);
+    slot.message.receipt_handle = boost::uuids::nil_uuid();
+    make_visible(idx);
+    leave_in_flight(idx);
+  }
+}
+
+void Queue::release_delayed(long ts) {
+  delayed.advance(ts, [this](uint32_t slot) {
+    slots[slot].message.visible_at = 0;
+    link_after(arrivals, &Slot::arrival, arrivals.tail, slot);
+    make_visible(slot);
+  });
+}
+
+void Queue::release(long ts) {
+  release_expired(ts);
+  release_delayed(ts);
+}
+
+template <typename Fn>
+void Queue::pop_visible(size_t count, Fn fn) {
+  size_t popped = 0;
+  while (popped < count && ready.head != NO_SLOT) {
+    auto idx = ready.head;
+    unlink(ready, &Slot::visible, idx);
+    popped += fn(idx);
+  }
+
+  // a group hands out its messages in order and stays locked until they are
+  // deleted or visible again, the next group gets the rest of the count
+  while (popped < count && !ready_groups.empty()) {
+    auto idx = ready_groups.front();
+    ready_groups.pop_front();
+    auto& group = groups[idx];
+    group.queued = false;
+    while (popped < count && group.visible.head != NO_SLOT) {
+      auto slot = group.visible.head;
+      unlink(group.visible, &Slot::visible, slot);
+      popped += fn(slot);
+    }
+    // groups emptied by expiry while queued are dropped here
+    settle_group(idx);
+  }
+}
+
+void Queue::move_out(const std::vector<uint32_t>& idxs,
+                     std::vector<MovedMessage>& out) {
+  // freed only after popping, so that no group is settled midway
+  for (auto idx : idxs) {
+    auto& slot = slots[idx];
+    auto group_id = slot.group == NO_GROUP ? "" : groups[slot.group].id;
+    // the body is shared, not copied
+    out.push_back(MovedMessage{slot.message, std::move(group_id)});
+    free_slot(idx);
+  }
+}
+
+std::vector<Message> Queue::receive(int count, long ts,
+                                    long visibility_timeout,
+                                    boost::uuids::random_generator& gen,
+                                    uint32_t max_receive_count,
+                                    std::vector<MovedMessage>* dead_letters) {
+  release(ts);
+  if (count < 1) {
+    return {};
+  }
+
+  std::vector<Message> received;
+  std::vector<uint32_t> dead;
+  pop_visible(count, [&](uint32_t idx) {
+    auto& slot = slots[idx];
+    if (max_receive_count > 0 &&
+        slot.message.receive_count >= max_receive_count) {
+      dead.push_back(idx);
+      return false;
+    }
+    slot.message.receipt_handle = gen();
+    if (receipt_tag.has_value()) {
+      slot.message.receipt_handle.data[0] = receipt_tag.value();
+    }
+    slot.message.visible_at = ts + visibility_timeout;
+    slot.message.receive_count++;
+    receipts[slot.message.receipt_handle] = idx;
+    heap_push(InFlightEntry{slot.message.visible_at, idx});
+    received.push_back(slot.message);
+    if (slot.group != NO_GROUP) {
+      groups[slot.group].in_flight++;
+    }
+    return true;
+  });
+  if (!dead.empty()) {
+    move_out(dead, *dead_letters);
+  }
+  return received;
+}
+
+std::vector<MovedMessage> Queue::take(int count, long ts) {
+  release(ts);
+  if (count < 1) {
+    return {};
+  }
+
+  std::vector<uint32_t> taken;
+  pop_visible(count, [&taken](uint32_t idx) {
+    taken.push_back(idx);
+    return true;
+  });
+  std::vector<MovedMessage> moved;
+  move_out(taken, moved);
+  return moved;
+}
+
+bool Queue::remove(const boost::uuids::uuid& receipt_handle, long ts) {
+  auto it = receipts.find(receipt_handle);
+  if (it == receipts.end()) {
+    return false;
+  }
+
+  // the visibility window the handle was issued for has expired, the message
+  // goes back to the ready queue on the next receive
+  auto idx = it->second;
+  if (slots[idx].message.visible_at <= ts) {
+    return false;
+  }
+
+  receipts.erase(it);
+  heap_remove(slots[idx].heap_pos);
+  auto group = slots[idx].group;
+  if (group != NO_GROUP) {
+    groups[group].in_flight--;
+  }
+  free_slot(idx);
+  return true;
+}
+
+size_t Queue::expire(long sent_before, size_t limit) {
+  size_t expired = 0;
+  while (expired < limit && arrivals.head != NO_SLOT &&
+         slots[arrivals.head].message.sent_at <= sent_before) {
+    auto idx = arrivals.head;
+    auto& slot = slots[idx];
+    if (slot.heap_pos != NOT_IN_FLIGHT) {
+      receipts.erase(slot.message.receipt_handle);
+      heap_remove(slot.heap_pos);
+      if (slot.group != NO_GROUP) {
+        groups[slot.group].in_flight--;
+      }
+    } else {
+      unlink(visible_list(idx), &Slot::visible, idx);
+    }
+    free_slot(idx);
+    expired++;
+  }
+  return expired;
+}
+
+bool Queue::change_visibility(const boost::uuids::uuid& receipt_handle,
+                              long ts, long visibility_timeout) {
+  auto it = receipts.find(receipt_handle);
+  if (it == receipts.end()) {
+    return false;
+  }
+
+  auto idx = it->second;
+  auto& slot = slots[idx];
+  if (slot.message.visible_at <= ts) {
+    return false;
+  }
+
+  slot.message.visible_at = ts + visibility_timeout;
+  in_flight[slot.heap_pos].visible_at = slot.message.visible_at;
+  heap_fix(slot.heap_pos);
+  return true;
+}
+
+Queue Queue::detach() {
+  Queue detached;
+  std::swap(*this, detached);
+  receipt_tag = detached.receipt_tag;
+  return detached;
+}
+
+size_t Queue::size() { return slots.size() - free_slots.size(); }
+
+size_t Queue::in_flight_size() { return in_flight.size(); }
+
+size_t Queue::delayed_size() { return delayed.size(); }
+
+std::optional<long> Queue::oldest_sent_at() {
+  if (arrivals.head == NO_SLOT) {
+    return {};
+  }
+  return slots[arrivals.head].message.sent_at;
+}
+
+std::optional<long> Queue::next_visible_at() {
+  auto visible_at = delayed.next_due();
+  if (!in_flight.empty()) {
+    auto expires_at = in_flight.front().visible_at;
+    if (!visible_at.has_value() || expires_at < visible_at.value()) {
+      visible_at = expires_at;
+    }
+  }
+  return visible_at;
+}
+
+size_t Queue::bytes() {
+  // an unordered_map node holds the entry plus a next pointer and the hash
+  auto receipt_bytes =
+      receipts.size() * (sizeof(decltype(receipts)::value_type) + 16) +
+      receipts.bucket_count() * sizeof(void*);
+  return slots.capacity() * sizeof(Slot) +
+         free_slots.capacity() * sizeof(uint32_t) +
+         ready_groups.size() * sizeof(uint32_t) +
+         in_flight.capacity() * sizeof(InFlightEntry) +
+         groups.capacity() * sizeof(MessageGroup) + receipt_bytes +
+         body_bytes;
+}
+
+void Queue::for_each(std::function<void(const Message&)> fn) {
+  for (auto idx = ready.head; idx != NO_SLOT; idx = slots[idx].visible.next) {
+    fn(slots[idx].message);
+  }
+  for (const auto& group : groups) {
+    for (auto idx = group.visible.head; idx != NO_SLOT;
+         idx = slots[idx].visible.next) {
+      fn(slots[idx].message);
+    }
+  }
+  delayed.for_each([this, &fn](uint32_t idx) { fn(slots[idx].message); });
+  for (const auto& slot : slots) {
+    if (slot.used && slot.heap_pos != NOT_IN_FLIGHT) {
+      fn(slot.message);
+    }
+  }
+}
+}  // namespace sqscpp
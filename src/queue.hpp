@@ -0,0 +1,193 @@
+#ifndef SQSCPP_QUEUE_H
+#define SQSCPP_QUEUE_H
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "message.hpp"
+#include "timer_wheel.hpp"
+
+namespace sqscpp {
+// heap position of messages that are not in flight
+const uint32_t NOT_IN_FLIGHT = UINT32_MAX;
+// group of messages sent to standard queues
+const uint32_t NO_GROUP = UINT32_MAX;
+// end of a list of slots
+const uint32_t NO_SLOT = UINT32_MAX;
+
+// Neighbours of a slot in a doubly linked SlotList.
+struct SlotLinks {
+  uint32_t prev = NO_SLOT;
+  uint32_t next = NO_SLOT;
+};
+
+struct SlotList {
+  uint32_t head = NO_SLOT;
+  uint32_t tail = NO_SLOT;
+};
+
+struct Slot {
+  Message message;
+  // position of the message's entry in the in-flight heap
+  uint32_t heap_pos;
+  uint32_t group;
+  // in the ready list or the group's list while visible
+  SlotLinks visible;
+  // in the list of all messages by arrival, once no longer delayed
+  SlotLinks arrival;
+  // order in which the message was sent to the queue
+  uint64_t seq;
+  bool used;
+};
+
+// Message group of a FIFO queue. Its visible messages are linked through
+// their slots in the order they were sent. While any of its messages is in
+// flight the group is locked and none of the others are received.
+struct MessageGroup {
+  std::string id;
+  SlotList visible;
+  // messages of the group in any state, the group is dropped at zero
+  uint32_t size;
+  uint32_t in_flight;
+  // whether the group waits in `ready_groups`, it is not dropped meanwhile
+  bool queued;
+};
+
+// Message taken out of its queue, for a dead-letter queue or a move task.
+struct MovedMessage {
+  Message message;
+  std::string group_id;
+};
+
+// Scheduled return of an in-flight message to the ready queue.
+struct InFlightEntry {
+  long visible_at;
+  uint32_t slot;
+};
+
+// Message storage of a single queue.
+//
+// Messages live in slots that are recycled through a free list. Visible
+// messages are linked into a ready list through their slots, in-flight ones
+// kept in a min-heap ordered by visibility expiry, so receive only touches
+// the messages it returns (plus the ones whose visibility expired since).
+// In-flight messages are also indexed by their receipt handle, and every
+// slot tracks the position of its heap entry, so deletes and visibility
+// changes are O(log n). Delayed messages wait in a timer wheel and join the
+// ready list when due.
+//
+// All messages but the delayed ones are also linked in order of arrival,
+// which is the order their retention period ends in, so expiring them
+// touches only the expired ones. A delayed message joins the arrival list
+// when it becomes visible and may expire up to its delay late.
+//
+// Messages of FIFO queues belong to message groups instead of the ready
+// list. Unlocked groups with visible messages take turns in `ready_groups`,
+// receive drains them round-robin from the front.
+//
+// Queue is not synchronised by itself, callers serialise access to it.
+class Queue {
+ private:
+  std::vector<Slot> slots;
+  std::vector<uint32_t> free_slots;
+  SlotList ready;
+  SlotList arrivals;
+  std::vector<InFlightEntry> in_flight;
+  TimerWheel delayed;
+  std::vector<MessageGroup> groups;
+  std::vector<uint32_t> free_groups;
+  std::unordered_map<std::string, uint32_t> group_ids;
+  std::deque<uint32_t> ready_groups;
+  uint64_t next_seq;
+  size_t body_bytes;
+  // stamped into the first byte of the receipt handles minted
+  std::optional<uint8_t> receipt_tag;
+  std::unordered_map<boost::uuids::uuid, uint32_t,
+                     boost::hash<boost::uuids::uuid>>
+      receipts;
+
+  uint32_t alloc_slot(Message msg, const std::string& group_id);
+  void free_slot(uint32_t slot);
+  // links `slot` after `after`, or at the front for NO_SLOT
+  void link_after(SlotList& list, SlotLinks Slot::*links, uint32_t after,
+                  uint32_t slot);
+  void unlink(SlotList& list, SlotLinks Slot::*links, uint32_t slot);
+  // the ready list or the list of the message's group
+  SlotList& visible_list(uint32_t slot);
+  uint32_t find_group(const std::string& group_id);
+  // queues the group for receiving once it is unlocked, drops it once empty
+  // and no longer queued
+  void settle_group(uint32_t group);
+  // returns a message to the ready list or to its group
+  void make_visible(uint32_t slot);
+  void leave_in_flight(uint32_t slot);
+  void release_expired(long ts);
+  void release_delayed(long ts);
+  // Pops up to `count` visible messages in receive order, standard ones
+  // first and then unlocked groups round-robin. `fn` gets their slots and
+  // returns whether a message counts towards `count`.
+  template <typename Fn>
+  void pop_visible(size_t count, Fn fn);
+  // frees the slots into `out`, sharing their bodies
+  void move_out(const std::vector<uint32_t>& idxs,
+                std::vector<MovedMessage>& out);
+  void heap_set(uint32_t pos, InFlightEntry entry);
+  void heap_push(InFlightEntry entry);
+  void heap_remove(uint32_t pos);
+  // restores the heap order around an entry whose expiry changed
+  void heap_fix(uint32_t pos);
+
+ public:
+  Queue();
+  // Makes the first byte of every receipt handle `tag`, so that handles
+  // tell which of several queues issued them.
+  void tag_receipts(uint8_t tag);
+  // `group_id` is empty for standard queues.
+  void push(Message msg, const std::string& group_id = "");
+  // Stores a message that becomes visible at its `visible_at`.
+  void push_delayed(Message msg, long ts, const std::string& group_id = "");
+  // Messages already received `max_receive_count` times, unless it is 0,
+  // are removed and appended to `dead_letters` instead of being returned.
+  std::vector<Message> receive(
+      int count, long ts, long visibility_timeout,
+      boost::uuids::random_generator& gen, uint32_t max_receive_count = 0,
+      std::vector<MovedMessage>* dead_letters = nullptr);
+  // Removes up to `count` visible messages, in the order receive would
+  // return them.
+  std::vector<MovedMessage> take(int count, long ts);
+  bool remove(const boost::uuids::uuid& receipt_handle, long ts);
+  // Makes in-flight messages whose visibility expired and delayed messages
+  // that are due visible, receive and take do so themselves.
+  void release(long ts);
+  // Removes up to `limit` messages sent at or before `sent_before`, whether
+  // visible or in flight, and returns how many.
+  size_t expire(long sent_before, size_t limit);
+  // Makes an in-flight message visible `visibility_timeout` seconds from
+  // `ts`, immediately for 0. Fails like remove for handles no longer valid.
+  bool change_visibility(const boost::uuids::uuid& receipt_handle, long ts,
+                         long visibility_timeout);
+  // Moves all messages into the returned Queue in O(1), leaving this one
+  // empty but tagged as before, so that they can be freed elsewhere.
+  Queue detach();
+  size_t size();
+  size_t in_flight_size();
+  size_t delayed_size();
+  // sent_at of the oldest message that is not delayed
+  std::optional<long> oldest_sent_at();
+  // earliest time an in-flight or delayed message may become visible, can be
+  // earlier than the actual one
+  std::optional<long> next_visible_at();
+  // approximate heap memory held by the queue, bodies included
+  size_t bytes();
+  void for_each(std::function<void(const Message&)> fn);
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_QUEUE_H
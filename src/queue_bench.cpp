@@ -0,0 +1,103 @@
+#include <malloc.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "body_pool.hpp"
+#include "queue.hpp"
+
+using namespace sqscpp;
+
+const int RECEIVES = 10000;
+const int MESSAGES = 1000000;
+const long NOW = 1000;
+
+Message new_message(boost::uuids::random_generator& gen, std::string body) {
+  return Message{gen(), boost::uuids::nil_uuid(), Digest(), 0,
+                 Body(body)};
+}
+
+// Average latency of a single-message receive while `in_flight` messages are
+// held invisible by earlier receives.
+double receive_latency_ns(boost::uuids::random_generator& gen, int in_flight) {
+  Queue q;
+  for (int i = 0; i < in_flight + RECEIVES; i++) {
+    q.push(new_message(gen, "body"));
+  }
+  q.receive(in_flight, NOW, 3600, gen);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < RECEIVES; i++) {
+    q.receive(1, NOW, 3600, gen);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / RECEIVES;
+}
+
+// Average latency of extending, then releasing, the lease of one of
+// `in_flight` messages.
+double change_visibility_ns(boost::uuids::random_generator& gen,
+                            int in_flight) {
+  Queue q;
+  for (int i = 0; i < in_flight; i++) {
+    q.push(new_message(gen, "body"));
+  }
+  auto msgs = q.receive(in_flight, NOW, 3600, gen);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < RECEIVES; i++) {
+    auto& msg = msgs[(size_t)i * 7919 % msgs.size()];
+    q.change_visibility(msg.receipt_handle, NOW, 7200 - i % 3600);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / RECEIVES;
+}
+
+size_t heap_in_use() {
+  auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Heap bytes per stored message with a `body_size` byte body, including the
+// queue's own bookkeeping and, when given, the body pool's slabs.
+double bytes_per_message(boost::uuids::random_generator& gen, int body_size,
+                         bool in_flight, std::shared_ptr<BodyPool> pool) {
+  auto before = heap_in_use();
+  Queue q;
+  for (int i = 0; i < MESSAGES; i++) {
+    auto msg = new_message(gen, "");
+    std::string body(body_size, 'x');
+    msg.body = pool ? pooled_body(pool, std::move(body)) : Body(body);
+    q.push(std::move(msg));
+  }
+  if (in_flight) {
+    q.receive(MESSAGES, NOW, 3600, gen);
+  }
+  return (double)(heap_in_use() - before) / MESSAGES;
+}
+
+auto main() -> int {
+  boost::uuids::random_generator gen;
+
+  std::cout << "in-flight\treceive ns/op\tchange visibility ns/op"
+            << std::endl;
+  for (int in_flight : {1000, 10000, 100000, 1000000}) {
+    std::cout << in_flight << "\t\t" << receive_latency_ns(gen, in_flight)
+              << "\t\t" << change_visibility_ns(gen, in_flight) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "body bytes\tstate\t\tbytes/message\tpooled" << std::endl;
+  for (int body_size : {16, 64, 256}) {
+    for (bool in_flight : {false, true}) {
+      std::cout << body_size << "\t\t" << (in_flight ? "in flight" : "visible")
+                << "\t" << (in_flight ? "" : "\t")
+                << bytes_per_message(gen, body_size, in_flight, nullptr)
+                << "\t\t"
+                << bytes_per_message(gen, body_size, in_flight,
+                                     std::make_shared<BodyPool>())
+                << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+}
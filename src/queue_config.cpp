@@ -0,0 +1,149 @@
+#include "queue_config.hpp"
+
+#include <charconv>
+#include <nlohmann/json.hpp>
+
+namespace sqscpp {
+static std::optional<long> parse_bounded(const std::string& value, long min,
+                                         long max) {
+  long parsed;
+  auto end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, parsed);
+  if (ec != std::errc() || ptr != end || parsed < min || parsed > max) {
+    return {};
+  }
+  return parsed;
+}
+
+static std::optional<bool> parse_bool(const std::string& value) {
+  if (value == "true") {
+    return true;
+  }
+  if (value == "false") {
+    return false;
+  }
+  return {};
+}
+
+std::optional<std::string> queue_name_from_arn(const std::string& arn) {
+  auto name_pos = arn.rfind(':');
+  if (!arn.starts_with("arn:") || name_pos + 1 == arn.size()) {
+    return {};
+  }
+  return arn.substr(name_pos + 1);
+}
+
+// Parses the JSON of a RedrivePolicy attribute, where maxReceiveCount may be
+// given as a number or a string.
+static std::optional<RedrivePolicy> parse_redrive_policy(
+    const std::string& value) {
+  auto j = nlohmann::json::parse(value, nullptr, false);
+  if (!j.is_object() || !j["deadLetterTargetArn"].is_string()) {
+    return {};
+  }
+
+  auto arn = j["deadLetterTargetArn"].get<std::string>();
+  auto qname = queue_name_from_arn(arn);
+  if (!qname.has_value()) {
+    return {};
+  }
+
+  auto& count = j["maxReceiveCount"];
+  std::optional<long> max_receive_count;
+  if (count.is_number_integer()) {
+    auto n = count.get<long>();
+    if (n >= 1 && n <= 1000) {
+      max_receive_count = n;
+    }
+  } else if (count.is_string()) {
+    max_receive_count = parse_bounded(count.get<std::string>(), 1, 1000);
+  }
+  if (!max_receive_count.has_value()) {
+    return {};
+  }
+  return RedrivePolicy{arn, qname.value(), max_receive_count.value()};
+}
+
+std::optional<QueueConfig> QueueConfig::with_attributes(
+    const std::map<std::string, std::string>& attrs) const {
+  QueueConfig config = *this;
+  for (const auto& [name, value] : attrs) {
+    std::optional<long> parsed;
+    long* field = nullptr;
+    if (name == VISIBILITY_TIMEOUT) {
+      parsed = parse_bounded(value, 0, 43200);
+      field = &config.visibility_timeout;
+    } else if (name == DELAY_SECONDS) {
+      parsed = parse_bounded(value, 0, 900);
+      field = &config.delay_seconds;
+    } else if (name == MESSAGE_RETENTION_PERIOD) {
+      parsed = parse_bounded(value, 60, 1209600);
+      field = &config.message_retention_period;
+    } else if (name == MAXIMUM_MESSAGE_SIZE) {
+      parsed = parse_bounded(value, 1024, 262144);
+      field = &config.maximum_message_size;
+    } else if (name == RECEIVE_MESSAGE_WAIT_TIME_SECONDS) {
+      parsed = parse_bounded(value, 0, 20);
+      field = &config.receive_message_wait_time_seconds;
+    } else if (name == PARTITIONS) {
+      parsed = parse_bounded(value, 1, MAX_PARTITIONS);
+      field = &config.partitions;
+    } else if (name == FIFO_QUEUE || name == CONTENT_BASED_DEDUPLICATION) {
+      auto flag = parse_bool(value);
+      if (!flag.has_value()) {
+        return {};
+      }
+      auto& target = name == FIFO_QUEUE ? config.fifo_queue
+                                        : config.content_based_deduplication;
+      target = flag.value();
+      continue;
+    } else if (name == REDRIVE_POLICY) {
+      // an empty policy removes the dead-letter queue
+      if (value.empty()) {
+        config.redrive_policy.reset();
+        continue;
+      }
+      config.redrive_policy = parse_redrive_policy(value);
+      if (!config.redrive_policy.has_value()) {
+        return {};
+      }
+      continue;
+    } else {
+      config.extra[name] = value;
+      continue;
+    }
+
+    if (!parsed.has_value()) {
+      return {};
+    }
+    *field = parsed.value();
+  }
+  return config;
+}
+
+std::map<std::string, std::string> QueueConfig::to_attributes() const {
+  auto attrs = extra;
+  attrs[VISIBILITY_TIMEOUT] = std::to_string(visibility_timeout);
+  attrs[DELAY_SECONDS] = std::to_string(delay_seconds);
+  attrs[MESSAGE_RETENTION_PERIOD] = std::to_string(message_retention_period);
+  attrs[MAXIMUM_MESSAGE_SIZE] = std::to_string(maximum_message_size);
+  attrs[RECEIVE_MESSAGE_WAIT_TIME_SECONDS] =
+      std::to_string(receive_message_wait_time_seconds);
+  // standard queues do not report the FIFO attributes
+  if (fifo_queue) {
+    attrs[FIFO_QUEUE] = "true";
+    attrs[CONTENT_BASED_DEDUPLICATION] =
+        content_based_deduplication ? "true" : "false";
+  }
+  if (partitions > 1) {
+    attrs[PARTITIONS] = std::to_string(partitions);
+  }
+  if (redrive_policy.has_value()) {
+    nlohmann::json j;
+    j["deadLetterTargetArn"] = redrive_policy->dead_letter_target_arn;
+    j["maxReceiveCount"] = redrive_policy->max_receive_count;
+    attrs[REDRIVE_POLICY] = j.dump();
+  }
+  return attrs;
+}
+}  // namespace sqscpp
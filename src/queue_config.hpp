@@ -0,0 +1,57 @@
+#ifndef SQSCPP_QUEUE_CONFIG_H
+#define SQSCPP_QUEUE_CONFIG_H
+
+#include <map>
+#include <optional>
+#include <string>
+
+namespace sqscpp {
+const std::string VISIBILITY_TIMEOUT = "VisibilityTimeout";
+const std::string DELAY_SECONDS = "DelaySeconds";
+const std::string MESSAGE_RETENTION_PERIOD = "MessageRetentionPeriod";
+const std::string MAXIMUM_MESSAGE_SIZE = "MaximumMessageSize";
+const std::string RECEIVE_MESSAGE_WAIT_TIME_SECONDS =
+    "ReceiveMessageWaitTimeSeconds";
+const std::string FIFO_QUEUE = "FifoQueue";
+const std::string CONTENT_BASED_DEDUPLICATION = "ContentBasedDeduplication";
+const std::string REDRIVE_POLICY = "RedrivePolicy";
+// sqscpp extension, not an AWS attribute
+const std::string PARTITIONS = "Partitions";
+const long MAX_PARTITIONS = 64;
+
+// Moves messages received more than `max_receive_count` times to the
+// dead-letter queue, which is addressed by the name in its ARN.
+struct RedrivePolicy {
+  std::string dead_letter_target_arn;
+  std::string dead_letter_queue_name;
+  long max_receive_count;
+};
+
+// Name of the queue an SQS ARN points at, nothing when it is not an ARN.
+std::optional<std::string> queue_name_from_arn(const std::string& arn);
+
+// Queue attributes parsed once when a queue is created or updated, so that
+// the send and receive paths never look at attribute strings. Attributes
+// without a typed field are kept verbatim in `extra`.
+struct QueueConfig {
+  long visibility_timeout = 30;
+  long delay_seconds = 0;
+  long message_retention_period = 345600;
+  long maximum_message_size = 262144;
+  long receive_message_wait_time_seconds = 0;
+  bool fifo_queue = false;
+  bool content_based_deduplication = false;
+  std::optional<RedrivePolicy> redrive_policy;
+  // stripes of a standard queue, each with a lock and messages of its own
+  long partitions = 1;
+  std::map<std::string, std::string> extra;
+
+  // Returns a copy with `attrs` applied, or nothing when one of them holds
+  // a value SQS would reject.
+  std::optional<QueueConfig> with_attributes(
+      const std::map<std::string, std::string>& attrs) const;
+  std::map<std::string, std::string> to_attributes() const;
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_QUEUE_CONFIG_H
@@ -0,0 +1,88 @@
+#include "queue_config.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace sqscpp;
+
+TEST(queue_config_test, with_attributes_parses_typed_fields) {
+  auto config = QueueConfig().with_attributes(
+      {{"VisibilityTimeout", "10"}, {"DelaySeconds", "5"}, {"Owner", "me"}});
+
+  EXPECT_EQ(config.has_value(), true);
+  EXPECT_EQ(config->visibility_timeout, 10);
+  EXPECT_EQ(config->delay_seconds, 5);
+  EXPECT_EQ(config->maximum_message_size, 262144);
+  EXPECT_EQ(config->extra.at("Owner"), "me");
+}
+
+TEST(queue_config_test, with_attributes_rejects_invalid_values) {
+  QueueConfig config;
+
+  EXPECT_FALSE(config.with_attributes({{"DelaySeconds", "901"}}).has_value());
+  EXPECT_FALSE(config.with_attributes({{"DelaySeconds", "5s"}}).has_value());
+  EXPECT_FALSE(
+      config.with_attributes({{"MessageRetentionPeriod", ""}}).has_value());
+}
+
+TEST(queue_config_test, to_attributes) {
+  auto config = QueueConfig().with_attributes({{"Owner", "me"}}).value();
+  auto attrs = config.to_attributes();
+
+  EXPECT_EQ(attrs.at("VisibilityTimeout"), "30");
+  EXPECT_EQ(attrs.at("ReceiveMessageWaitTimeSeconds"), "0");
+  EXPECT_EQ(attrs.at("Owner"), "me");
+}
+
+TEST(queue_config_test, fifo_attributes) {
+  auto config = QueueConfig().with_attributes(
+      {{"FifoQueue", "true"}, {"ContentBasedDeduplication", "true"}});
+
+  ASSERT_EQ(config.has_value(), true);
+  EXPECT_TRUE(config->fifo_queue);
+  EXPECT_TRUE(config->content_based_deduplication);
+  EXPECT_EQ(config->to_attributes().at("FifoQueue"), "true");
+  EXPECT_FALSE(QueueConfig().to_attributes().contains("FifoQueue"));
+  EXPECT_FALSE(QueueConfig().with_attributes({{"FifoQueue", "1"}}));
+}
+
+TEST(queue_config_test, redrive_policy) {
+  const std::string arn = "arn:aws:sqs:us-east-1:000000000000:dlq";
+  auto config = QueueConfig().with_attributes(
+      {{"RedrivePolicy", R"({"deadLetterTargetArn":")" + arn +
+                             R"(","maxReceiveCount":"3"})"}});
+
+  ASSERT_EQ(config.has_value(), true);
+  ASSERT_TRUE(config->redrive_policy.has_value());
+  EXPECT_EQ(config->redrive_policy->dead_letter_queue_name, "dlq");
+  EXPECT_EQ(config->redrive_policy->max_receive_count, 3);
+  EXPECT_EQ(config->to_attributes().at("RedrivePolicy"),
+            R"({"deadLetterTargetArn":")" + arn + R"(","maxReceiveCount":3})");
+
+  auto removed = config->with_attributes({{"RedrivePolicy", ""}});
+  EXPECT_FALSE(removed->redrive_policy.has_value());
+  EXPECT_FALSE(removed->to_attributes().contains("RedrivePolicy"));
+
+  EXPECT_FALSE(QueueConfig()
+                   .with_attributes({{"RedrivePolicy",
+                                      R"({"deadLetterTargetArn":"dlq",)"
+                                      R"("maxReceiveCount":3})"}})
+                   .has_value());
+  EXPECT_FALSE(QueueConfig()
+                   .with_attributes({{"RedrivePolicy",
+                                      R"({"deadLetterTargetArn":"arn:x:dlq",)"
+                                      R"("maxReceiveCount":0})"}})
+                   .has_value());
+  EXPECT_FALSE(
+      QueueConfig().with_attributes({{"RedrivePolicy", "{"}}).has_value());
+}
+
+TEST(queue_config_test, partitions) {
+  auto config = QueueConfig().with_attributes({{"Partitions", "4"}});
+
+  ASSERT_EQ(config.has_value(), true);
+  EXPECT_EQ(config->partitions, 4);
+  EXPECT_EQ(config->to_attributes().at("Partitions"), "4");
+  EXPECT_FALSE(QueueConfig().to_attributes().contains("Partitions"));
+  EXPECT_FALSE(QueueConfig().with_attributes({{"Partitions", "0"}}));
+  EXPECT_FALSE(QueueConfig().with_attributes({{"Partitions", "65"}}));
+}
@@ -0,0 +1,383 @@
+#include "queue.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace sqscpp;
+
+Message new_message(std::string body) {
+  static boost::uuids::random_generator gen;
+  Message msg;
+  msg.message_id = gen();
+  msg.receipt_handle = boost::uuids::nil_uuid();
+  msg.body = Body(body);
+  msg.visible_at = 0;
+  return msg;
+}
+
+TEST(queue_test, receive_mints_receipt_handle) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  auto msgs = q.receive(1, 100, 30, gen);
+
+  EXPECT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "a");
+  EXPECT_FALSE(msgs[0].receipt_handle.is_nil());
+  EXPECT_NE(msgs[0].receipt_handle, msgs[0].message_id);
+}
+
+TEST(queue_test, receive_of_no_messages_takes_none) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"));
+
+  EXPECT_EQ(q.receive(0, 100, 30, gen).size(), 0);
+  EXPECT_EQ(q.receive(-1, 100, 30, gen).size(), 0);
+  EXPECT_EQ(q.take(-1, 100).size(), 0);
+  EXPECT_EQ(q.in_flight_size(), 0);
+  EXPECT_EQ(q.size(), 2);
+}
+
+TEST(queue_test, remove_by_receipt_handle) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"));
+  q.push(new_message("c"));
+  auto msgs = q.receive(3, 100, 30, gen);
+
+  EXPECT_FALSE(q.remove(msgs[1].message_id, 100));
+  EXPECT_TRUE(q.remove(msgs[1].receipt_handle, 100));
+  EXPECT_FALSE(q.remove(msgs[1].receipt_handle, 100));
+  EXPECT_EQ(q.size(), 2);
+  EXPECT_TRUE(q.remove(msgs[0].receipt_handle, 100));
+  EXPECT_TRUE(q.remove(msgs[2].receipt_handle, 100));
+  EXPECT_EQ(q.size(), 0);
+}
+
+TEST(queue_test, remove_rejects_expired_receipt_handle) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  auto msgs = q.receive(1, 100, 30, gen);
+
+  EXPECT_FALSE(q.remove(msgs[0].receipt_handle, 130));
+  EXPECT_EQ(q.size(), 1);
+}
+
+TEST(queue_test, remove_rejects_superseded_receipt_handle) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  auto first = q.receive(1, 100, 30, gen);
+  auto second = q.receive(1, 130, 30, gen);
+
+  EXPECT_EQ(second.size(), 1);
+  EXPECT_NE(first[0].receipt_handle, second[0].receipt_handle);
+  EXPECT_FALSE(q.remove(first[0].receipt_handle, 140));
+  EXPECT_TRUE(q.remove(second[0].receipt_handle, 140));
+}
+
+TEST(queue_test, remove_survives_compaction) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  for (int i = 0; i < 10; i++) {
+    q.push(new_message(std::to_string(i)));
+  }
+  auto msgs = q.receive(10, 100, 30, gen);
+
+  // keep the head alive so tombstones pile up behind it
+  for (int i = 1; i < 9; i++) {
+    EXPECT_TRUE(q.remove(msgs[i].receipt_handle, 100));
+  }
+  EXPECT_EQ(q.size(), 2);
+  EXPECT_TRUE(q.remove(msgs[9].receipt_handle, 100));
+  EXPECT_TRUE(q.remove(msgs[0].receipt_handle, 100));
+  EXPECT_EQ(q.size(), 0);
+}
+
+TEST(queue_test, receive_skips_in_flight_messages) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"));
+  q.receive(1, 100, 30, gen);
+  auto msgs = q.receive(2, 110, 30, gen);
+
+  EXPECT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "b");
+  EXPECT_EQ(q.in_flight_size(), 2);
+  EXPECT_EQ(q.receive(1, 120, 30, gen).size(), 0);
+}
+
+TEST(queue_test, receive_returns_expired_messages) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"));
+  q.receive(1, 100, 10, gen);
+  q.receive(1, 100, 30, gen);
+  auto msgs = q.receive(2, 110, 30, gen);
+
+  EXPECT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "a");
+  EXPECT_EQ(q.in_flight_size(), 2);
+}
+
+TEST(queue_test, detach_moves_messages_out) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"));
+  auto msgs = q.receive(1, 100, 30, gen);
+  auto detached = q.detach();
+
+  EXPECT_EQ(q.size(), 0);
+  EXPECT_EQ(q.receive(1, 200, 30, gen).size(), 0);
+  EXPECT_FALSE(q.remove(msgs[0].receipt_handle, 100));
+  EXPECT_EQ(detached.size(), 2);
+  EXPECT_GT(detached.bytes(), q.bytes());
+
+  q.push(new_message("c"));
+  EXPECT_EQ(q.receive(2, 200, 30, gen).size(), 1);
+}
+
+TEST(queue_test, delayed_message_becomes_visible_when_due) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  auto msg = new_message("a");
+  msg.visible_at = 110;
+  q.push_delayed(std::move(msg), 100);
+  q.push(new_message("b"));
+
+  EXPECT_EQ(q.delayed_size(), 1);
+  EXPECT_EQ(q.next_visible_at(), 110);
+  auto msgs = q.receive(10, 109, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "b");
+
+  msgs = q.receive(10, 110, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "a");
+  EXPECT_EQ(q.delayed_size(), 0);
+  EXPECT_EQ(q.in_flight_size(), 2);
+}
+
+TEST(queue_test, change_visibility_extends_and_releases) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  auto msgs = q.receive(1, 100, 30, gen);
+  auto receipt_handle = msgs[0].receipt_handle;
+
+  EXPECT_TRUE(q.change_visibility(receipt_handle, 110, 60));
+  EXPECT_EQ(q.receive(1, 140, 30, gen).size(), 0);
+  EXPECT_EQ(q.receive(1, 170, 30, gen).size(), 1);
+  EXPECT_FALSE(q.change_visibility(receipt_handle, 170, 60));
+
+  msgs = q.receive(1, 200, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_TRUE(q.change_visibility(msgs[0].receipt_handle, 205, 0));
+  EXPECT_FALSE(q.remove(msgs[0].receipt_handle, 205));
+  EXPECT_EQ(q.receive(1, 205, 30, gen).size(), 1);
+}
+
+TEST(queue_test, change_visibility_keeps_expiry_order) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  for (auto body : {"a", "b", "c", "d"}) {
+    q.push(new_message(body));
+  }
+  auto msgs = q.receive(4, 100, 30, gen);
+
+  // a expires last, d first
+  EXPECT_TRUE(q.change_visibility(msgs[0].receipt_handle, 100, 90));
+  EXPECT_TRUE(q.change_visibility(msgs[3].receipt_handle, 100, 10));
+  EXPECT_TRUE(q.remove(msgs[2].receipt_handle, 100));
+  EXPECT_EQ(q.next_visible_at(), 110);
+
+  auto released = q.receive(4, 110, 30, gen);
+  ASSERT_EQ(released.size(), 1);
+  EXPECT_EQ(released[0].body.view(), "d");
+  released = q.receive(4, 130, 30, gen);
+  ASSERT_EQ(released.size(), 1);
+  EXPECT_EQ(released[0].body.view(), "b");
+  // a, and d and b received again
+  EXPECT_EQ(q.in_flight_size(), 3);
+}
+
+TEST(queue_test, group_is_received_in_order_and_locked) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a1"), "a");
+  q.push(new_message("a2"), "a");
+  q.push(new_message("a3"), "a");
+
+  auto first = q.receive(1, 100, 30, gen);
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_EQ(first[0].body.view(), "a1");
+  // the group stays locked while a1 is in flight
+  EXPECT_TRUE(q.receive(10, 100, 30, gen).empty());
+
+  EXPECT_TRUE(q.remove(first[0].receipt_handle, 100));
+  auto rest = q.receive(10, 100, 30, gen);
+  ASSERT_EQ(rest.size(), 2);
+  EXPECT_EQ(rest[0].body.view(), "a2");
+  EXPECT_EQ(rest[1].body.view(), "a3");
+}
+
+TEST(queue_test, groups_take_turns) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a1"), "a");
+  q.push(new_message("b1"), "b");
+  q.push(new_message("a2"), "a");
+  q.push(new_message("c1"), "c");
+
+  auto a = q.receive(2, 100, 30, gen);
+  ASSERT_EQ(a.size(), 2);
+  EXPECT_EQ(a[0].body.view(), "a1");
+  EXPECT_EQ(a[1].body.view(), "a2");
+  auto bc = q.receive(10, 100, 30, gen);
+  ASSERT_EQ(bc.size(), 2);
+  EXPECT_EQ(bc[0].body.view(), "b1");
+  EXPECT_EQ(bc[1].body.view(), "c1");
+}
+
+TEST(queue_test, expired_group_message_returns_to_front) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a1"), "a");
+  q.push(new_message("a2"), "a");
+  auto first = q.receive(1, 100, 30, gen);
+  q.push(new_message("a3"), "a");
+
+  // a1 becomes visible again ahead of the messages sent after it
+  auto msgs = q.receive(10, 130, 30, gen);
+  ASSERT_EQ(msgs.size(), 3);
+  EXPECT_EQ(msgs[0].body.view(), "a1");
+  EXPECT_EQ(msgs[1].body.view(), "a2");
+  EXPECT_EQ(msgs[2].body.view(), "a3");
+  for (const auto& msg : msgs) {
+    EXPECT_TRUE(q.remove(msg.receipt_handle, 130));
+  }
+  EXPECT_EQ(q.size(), 0);
+
+  // the emptied group is dropped and starts afresh
+  q.push(new_message("a4"), "a");
+  EXPECT_EQ(q.receive(10, 130, 30, gen).size(), 1);
+}
+
+TEST(queue_test, receive_moves_out_dead_letters) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("b"), "g");
+  std::vector<MovedMessage> dead_letters;
+
+  auto msgs = q.receive(10, 100, 30, gen, 2, &dead_letters);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[0].receive_count, 1);
+  msgs = q.receive(10, 130, 30, gen, 2, &dead_letters);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(msgs[1].receive_count, 2);
+  EXPECT_TRUE(dead_letters.empty());
+
+  // the third receive would exceed the maximum
+  EXPECT_TRUE(q.receive(10, 160, 30, gen, 2, &dead_letters).empty());
+  ASSERT_EQ(dead_letters.size(), 2);
+  EXPECT_EQ(dead_letters[0].message.body.view(), "a");
+  EXPECT_EQ(dead_letters[0].group_id, "");
+  EXPECT_EQ(dead_letters[1].message.body.view(), "b");
+  EXPECT_EQ(dead_letters[1].group_id, "g");
+  EXPECT_EQ(dead_letters[1].message.receive_count, 2);
+  EXPECT_EQ(q.size(), 0);
+}
+
+TEST(queue_test, take_removes_visible_messages_in_order) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(new_message("a"));
+  q.push(new_message("g1"), "g");
+  q.push(new_message("g2"), "g");
+  q.push(new_message("b"));
+  auto in_flight = q.receive(1, 100, 30, gen);
+
+  auto moved = q.take(2, 100);
+  ASSERT_EQ(moved.size(), 2);
+  EXPECT_EQ(moved[0].message.body.view(), "b");
+  EXPECT_EQ(moved[1].message.body.view(), "g1");
+  EXPECT_EQ(moved[1].group_id, "g");
+  moved = q.take(10, 100);
+  ASSERT_EQ(moved.size(), 1);
+  EXPECT_EQ(moved[0].message.body.view(), "g2");
+
+  // in-flight messages stay until they are visible again
+  EXPECT_EQ(q.size(), 1);
+  EXPECT_EQ(q.take(10, 130).size(), 1);
+  EXPECT_EQ(q.size(), 0);
+}
+
+Message sent_at(std::string body, long ts) {
+  auto msg = new_message(body);
+  msg.sent_at = ts;
+  return msg;
+}
+
+TEST(queue_test, expire_removes_oldest_messages_up_to_limit) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(sent_at("a", 10));
+  q.push(sent_at("b", 20));
+  q.push(sent_at("c", 30));
+  q.push(sent_at("d", 40));
+  auto in_flight = q.receive(1, 100, 30, gen);
+
+  // in-flight messages expire too, their receipt handles become invalid
+  EXPECT_EQ(q.expire(30, 2), 2);
+  EXPECT_EQ(q.size(), 2);
+  EXPECT_EQ(q.in_flight_size(), 0);
+  EXPECT_FALSE(q.remove(in_flight[0].receipt_handle, 100));
+
+  EXPECT_EQ(q.expire(30, 2), 1);
+  EXPECT_EQ(q.expire(30, 2), 0);
+  auto msgs = q.receive(10, 100, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "d");
+}
+
+TEST(queue_test, expire_unlocks_and_drops_groups) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  q.push(sent_at("a1", 10), "a");
+  q.push(sent_at("a2", 20), "a");
+  q.push(sent_at("b1", 20), "b");
+  q.push(sent_at("a3", 50), "a");
+  auto first = q.receive(1, 100, 30, gen);
+  ASSERT_EQ(first[0].body.view(), "a1");
+
+  // group b is emptied while waiting for its turn
+  EXPECT_EQ(q.expire(20, 10), 3);
+  auto msgs = q.receive(10, 100, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "a3");
+
+  q.push(sent_at("b2", 60), "b");
+  msgs = q.receive(10, 100, 30, gen);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "b2");
+}
+
+TEST(queue_test, delayed_message_expires_once_visible) {
+  boost::uuids::random_generator gen;
+  Queue q;
+  auto msg = sent_at("a", 10);
+  msg.visible_at = 110;
+  q.push_delayed(std::move(msg), 100);
+
+  EXPECT_EQ(q.expire(10, 10), 0);
+  q.receive(10, 110, 30, gen);
+  EXPECT_EQ(q.expire(10, 10), 1);
+  EXPECT_EQ(q.size(), 0);
+}
@@ -0,0 +1,51 @@
+#include "reclaimer.hpp"
+
+namespace sqscpp {
+Reclaimer::Reclaimer()
+    : busy(false),
+      bytes(0),
+      worker([this](std::stop_token stop) { run(stop); }) {}
+
+void Reclaimer::retire(Queue queue) {
+  bytes += queue.bytes();
+  {
+    std::lock_guard lock(mtx);
+    pending.push_back(std::move(queue));
+  }
+  cv.notify_all();
+}
+
+size_t Reclaimer::pending_bytes() { return bytes; }
+
+void Reclaimer::drain() {
+  std::unique_lock lock(mtx);
+  cv.wait(lock, [this]() { return pending.empty() && !busy; });
+}
+
+void Reclaimer::run(std::stop_token stop) {
+  std::unique_lock lock(mtx);
+  while (true) {
+    cv.wait(lock, stop, [this]() { return !pending.empty(); });
+    if (pending.empty()) {
+      // stop requested and nothing left to free
+      return;
+    }
+
+    auto batch = std::move(pending);
+    pending.clear();
+    busy = true;
+    lock.unlock();
+
+    size_t freed = 0;
+    for (auto& queue : batch) {
+      freed += queue.bytes();
+    }
+    batch.clear();
+    bytes -= freed;
+
+    lock.lock();
+    busy = false;
+    cv.notify_all();
+  }
+}
+}  // namespace sqscpp
@@ -0,0 +1,38 @@
+#ifndef SQSCPP_RECLAIMER_H
+#define SQSCPP_RECLAIMER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "queue.hpp"
+
+namespace sqscpp {
+// Frees message storage detached from purged and deleted queues on a
+// background thread, so that the request dropping millions of messages does
+// not run their destructors itself.
+class Reclaimer {
+ private:
+  std::mutex mtx;
+  std::condition_variable_any cv;
+  std::vector<Queue> pending;
+  // set while the worker frees a batch taken out of `pending`
+  bool busy;
+  std::atomic<size_t> bytes;
+  std::jthread worker;
+
+  void run(std::stop_token stop);
+
+ public:
+  Reclaimer();
+  void retire(Queue queue);
+  // approximate memory of retired queues not freed yet
+  size_t pending_bytes();
+  // blocks until everything retired so far has been freed
+  void drain();
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_RECLAIMER_H
@@ -4,23 +4,68 @@
 #include "serde.hpp"
 
 namespace sqscpp {
-std::function<restinio::request_handling_status_t(restinio::request_handle_t)>
-handler_factory(SQS* sqs, JsonSerde* json_serde, HtmlSerde* html_serde) {
-  return [sqs, json_serde, html_serde](restinio::request_handle_t req) {
+static std::function<
+    restinio::request_handling_status_t(restinio::request_handle_t)>
+protocol_handler(QueryHandler handler, JsonSerde* json_serde,
+                 CborSerde* cbor_serde, HtmlSerde* html_serde) {
+  return [handler = std::move(handler), json_serde, cbor_serde,
+          html_serde](restinio::request_handle_t req) {
     auto headers = req->header();
     auto protocol = extract_protocol(&headers);
 
     switch (protocol) {
       case AWSJsonProtocol1_0:
-        return sqs_query_handler(sqs, json_serde, &headers, req);
+        return handler(json_serde, &headers, req);
+      case SmithyRpcV2Cbor:
+        return cbor_query_handler(handler, cbor_serde, &headers, req);
       case TextHtml:
-        return html_query_handler(sqs, html_serde, &headers, req);
+        return html_query_handler(handler, html_serde, &headers, req);
       default:
         return restinio::request_rejected();
     }
   };
 }
 
+std::function<restinio::request_handling_status_t(restinio::request_handle_t)>
+handler_factory(SQS* sqs, JsonSerde* json_serde, CborSerde* cbor_serde,
+                HtmlSerde* html_serde) {
+  return protocol_handler(
+      [sqs](Serde* serde, restinio::http_request_header_t* headers,
+            restinio::request_handle_t req) {
+        return sqs_query_handler(sqs, serde, headers, req);
+      },
+      json_serde, cbor_serde, html_serde);
+}
+
+std::function<restinio::request_handling_status_t(restinio::request_handle_t)>
+shard_handler_factory(std::vector<Shard>* shards, size_t index,
+                      JsonSerde* json_serde, CborSerde* cbor_serde,
+                      HtmlSerde* html_serde) {
+  return protocol_handler(
+      [shards, index](Serde* serde, restinio::http_request_header_t* headers,
+                      restinio::request_handle_t req) {
+        return shard_query_handler(shards, index, serde, headers, req);
+      },
+      json_serde, cbor_serde, html_serde);
+}
+
+restinio::request_handling_status_t shard_query_handler(
+    std::vector<Shard>* shards, size_t index, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req) {
+  auto owner = request_shard(serde, headers, req, shards->size());
+  if (!owner.has_value() || owner.value() == index) {
+    return sqs_query_handler((*shards)[index].sqs, serde, headers, req);
+  }
+  // the response goes out on the strand of the connection, whichever
+  // thread writes it
+  auto& shard = (*shards)[owner.value()];
+  shard.mailbox->post(
+      [sqs = shard.sqs, serde, headers = *headers, req]() mutable {
+        sqs_query_handler(sqs, serde, &headers, req);
+      });
+  return restinio::request_accepted();
+}
+
 restinio::request_handling_status_t sqs_query_handler(
     SQS* sqs, Serde* serde, restinio::http_request_header_t* headers,
     restinio::request_handle_t req) {
@@ -40,18 +85,27 @@ restinio::request_handling_status_t sqs_query_handler(
         return resp_err(serde, req, BadRequestError("invalid request body"));
       }
       auto qurl = sqs->create_queue(body.value().get());
-      auto res = CreateQueueResponse{qurl};
+      if (!qurl.has_value()) {
+        return resp_err(serde, req,
+                        BadRequestError("Invalid value for a queue attribute.",
+                                        "InvalidAttributeValue"));
+      }
+      auto res = CreateQueueResponse{qurl.value()};
       return resp_ok(serde, req, serde->serialize(&res));
     }
     case SQSListQueues: {
-      auto qurls = sqs->get_queue_urls();
-      std::vector<QueueInfo> queues;
-      for (auto& qurl : *qurls) {
-        auto count = sqs->get_message_count(qurl);
-        queues.push_back(QueueInfo{qurl, sqs->get_queue_name(qurl), count});
+      auto input = req->body();
+      auto body = serde->deserialize_list_queues_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
       }
-      auto res = ListQueuesResponse{&queues};
-      return resp_ok(serde, req, serde->serialize(&res));
+      auto [status, res] = sqs->list_queues(body.value().get());
+      if (status == MaxResultsInvalid) {
+        return resp_err(
+            serde, req,
+            BadRequestError("Value for parameter MaxResults is invalid."));
+      }
+      return resp_ok(serde, req, serde->serialize(res.get()));
     }
     case SQSDeleteQueue: {
       auto input = req->body();
@@ -61,10 +115,9 @@ restinio::request_handling_status_t sqs_query_handler(
       }
       auto qurl = body.value()->get_queue_url();
       if (!sqs->delete_queue(qurl)) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
-      return resp_ok(serde, req, "{}");
+      return resp_empty(serde, req);
     }
     case SQSGetQueueUrl: {
       auto input = req->body();
@@ -74,8 +127,7 @@ restinio::request_handling_status_t sqs_query_handler(
       }
       auto qurl = sqs->get_queue_url(body.value()->get_queue_name());
       if (!qurl.has_value()) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
       auto res = GetQueueUrlResponse{qurl.value()};
       return resp_ok(serde, req, serde->serialize(&res));
@@ -89,10 +141,84 @@ restinio::request_handling_status_t sqs_query_handler(
       auto tags = body.value()->get_tags();
       auto ok = sqs->tag_queue(body.value()->get_queue_url(), &tags);
       if (!ok) {
+        return resp_err(serde, req, QueueDoesNotExistError());
+      }
+      return resp_empty(serde, req);
+    }
+    case SQSListDeadLetterSourceQueues: {
+      auto input = req->body();
+      auto body =
+          serde->deserialize_list_dead_letter_source_queues_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto qurls =
+          sqs->list_dead_letter_source_queues(body.value()->get_queue_url());
+      if (!qurls.has_value()) {
+        return resp_err(serde, req, QueueDoesNotExistError());
+      }
+      auto res = ListDeadLetterSourceQueuesResponse{std::move(qurls.value())};
+      return resp_ok(serde, req, serde->serialize(&res));
+    }
+    case SQSStartMessageMoveTask: {
+      auto input = req->body();
+      auto body = serde->deserialize_start_message_move_task_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto [status, res] = sqs->start_message_move_task(body.value().get());
+      switch (status) {
+        case MoveTaskStarted:
+          return resp_ok(serde, req, serde->serialize(res.get()));
+        case MoveSourceNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        case MoveSourceNotDeadLetterQueue:
+          return resp_err(serde, req,
+                          BadRequestError("Source queue must be configured "
+                                          "as a Dead Letter Queue."));
+        case MoveDestinationInvalid:
+          return resp_err(serde, req,
+                          BadRequestError("Value for parameter DestinationArn "
+                                          "is invalid."));
+        case MoveRateInvalid:
+          return resp_err(serde, req,
+                          BadRequestError("Value for parameter "
+                                          "MaxNumberOfMessagesPerSecond is "
+                                          "invalid."));
+        default:
+          return resp_err(serde, req,
+                          BadRequestError("There is already a task running. "
+                                          "Only one active task is allowed "
+                                          "for each source queue.",
+                                          "UnsupportedOperation"));
+      }
+    }
+    case SQSCancelMessageMoveTask: {
+      auto input = req->body();
+      auto body = serde->deserialize_cancel_message_move_task_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto res = sqs->cancel_message_move_task(body.value().get());
+      if (!res.has_value()) {
         return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+                        BadRequestError("The specified task does not exist "
+                                        "or is not running.",
+                                        "ResourceNotFoundException"));
       }
-      return resp_ok(serde, req, "{}");
+      return resp_ok(serde, req, serde->serialize(res.value().get()));
+    }
+    case SQSListMessageMoveTasks: {
+      auto input = req->body();
+      auto body = serde->deserialize_list_message_move_tasks_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto res = sqs->list_message_move_tasks(body.value().get());
+      if (!res.has_value()) {
+        return resp_err(serde, req, QueueDoesNotExistError());
+      }
+      return resp_ok(serde, req, serde->serialize(res.value().get()));
     }
     case SQSListQueueTags: {
       auto input = req->body();
@@ -102,8 +228,7 @@ restinio::request_handling_status_t sqs_query_handler(
       }
       auto tags = sqs->get_queue_tags(body.value()->get_queue_url());
       if (!tags.has_value()) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
       auto res = ListQueueTagsResponse{tags.value().get()};
       return resp_ok(serde, req, serde->serialize(&res));
@@ -117,10 +242,40 @@ restinio::request_handling_status_t sqs_query_handler(
       auto keys = body.value()->get_tag_keys();
       auto ok = sqs->untag_queue(body.value()->get_queue_url(), &keys);
       if (!ok) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
-      return resp_ok(serde, req, "{}");
+      return resp_empty(serde, req);
+    }
+    case SQSSetQueueAttributes: {
+      auto input = req->body();
+      auto body = serde->deserialize_set_queue_attributes_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      switch (sqs->set_queue_attributes(body.value().get())) {
+        case AttributesSet:
+          return resp_empty(serde, req);
+        case AttributesQueueNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        default:
+          return resp_err(
+              serde, req,
+              BadRequestError("Invalid value for a queue attribute.",
+                              "InvalidAttributeValue"));
+      }
+    }
+    case SQSGetQueueAttributes: {
+      auto input = req->body();
+      auto body = serde->deserialize_get_queue_attributes_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto attrs = sqs->get_queue_attributes(body.value().get());
+      if (!attrs.has_value()) {
+        return resp_err(serde, req, QueueDoesNotExistError());
+      }
+      auto res = GetQueueAttributesResponse{attrs.value().get()};
+      return resp_ok(serde, req, serde->serialize(&res));
     }
     case SQSSendMessage: {
       auto input = req->body();
@@ -128,12 +283,32 @@ restinio::request_handling_status_t sqs_query_handler(
       if (!body.has_value()) {
         return resp_err(serde, req, BadRequestError("invalid request body"));
       }
-      auto res = sqs->send_message(body.value().get());
-      if (res == nullptr) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+      auto [status, res] = sqs->send_message(body.value().get());
+      switch (status) {
+        case MessageSent:
+          return resp_ok(serde, req, serde->serialize(res.get()));
+        case SendQueueNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        case DelaySecondsInvalid:
+          return resp_err(
+              serde, req,
+              BadRequestError("Value for parameter DelaySeconds is invalid."));
+        case MessageGroupIdMissing:
+          return resp_err(serde, req,
+                          BadRequestError("The request must contain the "
+                                          "parameter MessageGroupId.",
+                                          "MissingParameter"));
+        case DeduplicationIdMissing:
+          return resp_err(
+              serde, req,
+              BadRequestError("The queue should either have "
+                              "ContentBasedDeduplication enabled or "
+                              "MessageDeduplicationId provided explicitly."));
+        default:
+          return resp_err(
+              serde, req,
+              BadRequestError("The message is longer than the queue allows."));
       }
-      return resp_ok(serde, req, serde->serialize(res.get()));
     }
     case SQSPurgeQueue: {
       auto input = req->body();
@@ -142,10 +317,9 @@ restinio::request_handling_status_t sqs_query_handler(
         return resp_err(serde, req, BadRequestError("invalid request body"));
       }
       if (!sqs->purge_queue(body.value()->get_queue_url())) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
-      return resp_ok(serde, req, "{}");
+      return resp_empty(serde, req);
     }
     case SQSReceiveMessage: {
       auto input = req->body();
@@ -153,16 +327,105 @@ restinio::request_handling_status_t sqs_query_handler(
       if (!body.has_value()) {
         return resp_err(serde, req, BadRequestError("invalid request body"));
       }
-      auto msgs = sqs->receive(
-          body.value().get()->get_queue_url(),
-          body.value().get()->get_max_number_of_messages().value_or(1));
-      std::vector<ReceivedMessageResponse> res_msgs;
-      for (auto& msg : msgs) {
-        res_msgs.push_back(ReceivedMessageResponse{
-            msg.message_id, msg.message_id, msg.md5_of_body, msg.body});
+      auto status = sqs->receive_async(
+          body.value().get(), [serde, req](std::vector<Message> msgs) {
+            std::vector<ReceivedMessageResponse> res_msgs;
+            for (auto& msg : msgs) {
+              res_msgs.push_back(ReceivedMessageResponse{
+                  format_uuid(msg.message_id), format_uuid(msg.receipt_handle),
+                  format_digest(msg.md5_of_body), msg.body,
+                  msg.receive_count});
+            }
+            auto res = ReceivedMessagesResponse{res_msgs};
+            resp_ok(serde, req, serde->serialize(&res));
+          });
+      switch (status) {
+        case ReceiveQueueNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        case TooManyWaiters:
+          return resp_err(
+              serde, req,
+              BadRequestError("Too many receives are waiting on the queue.",
+                              "OverLimit"));
+        case MaxNumberOfMessagesInvalid:
+          return resp_err(serde, req,
+                          BadRequestError("Value for parameter "
+                                          "MaxNumberOfMessages is invalid."));
+        case WaitTimeSecondsInvalid:
+          return resp_err(
+              serde, req,
+              BadRequestError(
+                  "Value for parameter WaitTimeSeconds is invalid."));
+        case ReceiveVisibilityTimeoutInvalid:
+          return resp_err(
+              serde, req,
+              BadRequestError(
+                  "Value for parameter VisibilityTimeout is invalid."));
+        default:
+          // answered by the callback, now or once the receive completes
+          return restinio::request_accepted();
       }
-      auto res = ReceivedMessagesResponse{res_msgs};
-      return resp_ok(serde, req, serde->serialize(&res));
+    }
+    case SQSChangeMessageVisibility: {
+      auto input = req->body();
+      auto body = serde->deserialize_change_message_visibility_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      switch (sqs->change_message_visibility(body.value().get())) {
+        case VisibilityChanged:
+          return resp_empty(serde, req);
+        case VisibilityQueueNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        case VisibilityTimeoutInvalid:
+          return resp_err(
+              serde, req,
+              BadRequestError(
+                  "Value for parameter VisibilityTimeout is invalid."));
+        default:
+          return resp_err(
+              serde, req,
+              BadRequestError("The specified receipt handle isn't valid.",
+                              "ReceiptHandleIsInvalid"));
+      }
+    }
+    case SQSSendMessageBatch: {
+      auto input = req->body();
+      auto body = serde->deserialize_send_message_batch_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto [status, res] = sqs->send_message_batch(body.value().get());
+      if (status != BatchExecuted) {
+        return resp_err(serde, req, batch_error(status));
+      }
+      return resp_ok(serde, req, serde->serialize(res.get()));
+    }
+    case SQSDeleteMessageBatch: {
+      auto input = req->body();
+      auto body = serde->deserialize_delete_message_batch_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto [status, res] = sqs->delete_message_batch(body.value().get());
+      if (status != BatchExecuted) {
+        return resp_err(serde, req, batch_error(status));
+      }
+      return resp_ok(serde, req, serde->serialize(res.get()));
+    }
+    case SQSChangeMessageVisibilityBatch: {
+      auto input = req->body();
+      auto body =
+          serde->deserialize_change_message_visibility_batch_input(input);
+      if (!body.has_value()) {
+        return resp_err(serde, req, BadRequestError("invalid request body"));
+      }
+      auto [status, res] =
+          sqs->change_message_visibility_batch(body.value().get());
+      if (status != BatchExecuted) {
+        return resp_err(serde, req, batch_error(status));
+      }
+      return resp_ok(serde, req, serde->serialize(res.get()));
     }
     case SQSDeleteMessage: {
       auto input = req->body();
@@ -170,11 +433,17 @@ restinio::request_handling_status_t sqs_query_handler(
       if (!body.has_value()) {
         return resp_err(serde, req, BadRequestError("invalid request body"));
       }
-      if (!sqs->delete_message(body.value().get())) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+      switch (sqs->delete_message(body.value().get())) {
+        case MessageDeleted:
+          return resp_empty(serde, req);
+        case QueueNotFound:
+          return resp_err(serde, req, QueueDoesNotExistError());
+        default:
+          return resp_err(
+              serde, req,
+              BadRequestError("The specified receipt handle isn't valid.",
+                              "ReceiptHandleIsInvalid"));
       }
-      return resp_ok(serde, req, "{}");
     }
     case FullQueueData: {
       auto qname = extract_queue_name(headers);
@@ -183,8 +452,7 @@ restinio::request_handling_status_t sqs_query_handler(
       }
       auto res = sqs->get_queue_data(qname.value());
       if (res == nullptr) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
       return resp_ok(serde, req, serde->serialize(res.get()));
     }
@@ -195,12 +463,10 @@ restinio::request_handling_status_t sqs_query_handler(
       }
       auto qurl = sqs->get_queue_url(qname.value());
       if (!qurl.has_value()) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
       if (!sqs->purge_queue(qurl.value())) {
-        return resp_err(serde, req,
-                        BadRequestError("The specified queue does not exist."));
+        return resp_err(serde, req, QueueDoesNotExistError());
       }
       return req->create_response(restinio::status_permanent_redirect())
           .append_header(restinio::http_field::location,
@@ -211,13 +477,27 @@ restinio::request_handling_status_t sqs_query_handler(
     default:
       return resp_err(
           serde, req,
-          Error(restinio::status_not_implemented(), "action not implemented"));
+          Error(restinio::status_not_implemented(), "action not implemented",
+                "UnsupportedOperation"));
+  }
+}
+
+restinio::request_handling_status_t cbor_query_handler(
+    const QueryHandler& handler, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req) {
+  // the operation is named by the path instead of the target header
+  auto path = req->header().path();
+  if (!path.starts_with(RPC_V2_OPERATION_PATH)) {
+    return resp_err(serde, req, BadRequestError("operation not found"));
   }
+  std::string operation(path.substr(RPC_V2_OPERATION_PATH.size()));
+  headers->set_field(AWS_TARGET, "AmazonSQS." + operation);
+  return handler(serde, headers, req);
 }
 
 restinio::request_handling_status_t html_query_handler(
-    SQS* sqs, Serde* serde, restinio::http_request_header_t* headers,
-    restinio::request_handle_t req) {
+    const QueryHandler& handler, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req) {
   auto path = req->header().path();
   if (path == "/") {
     return req->create_response(restinio::status_permanent_redirect())
@@ -245,28 +525,71 @@ restinio::request_handling_status_t html_query_handler(
       }
     }
   }
-  return sqs_query_handler(sqs, serde, headers, req);
+  return handler(serde, headers, req);
+}
+
+Error batch_error(BatchStatus status) {
+  switch (status) {
+    case BatchQueueNotFound:
+      return QueueDoesNotExistError();
+    case BatchEmpty:
+      return BadRequestError("The batch request doesn't contain any entries.",
+                             "EmptyBatchRequest");
+    case BatchTooManyEntries:
+      return BadRequestError(
+          "The batch request contains more entries than permissible.",
+          "TooManyEntriesInBatchRequest");
+    case BatchIdsNotDistinct:
+      return BadRequestError(
+          "Two or more batch entries in the request have the same Id.",
+          "BatchEntryIdsNotDistinct");
+    case BatchEntryIdInvalid:
+      return BadRequestError(
+          "The Id of a batch entry in a batch request doesn't abide by the "
+          "specification.",
+          "InvalidBatchEntryId");
+    default:
+      return BadRequestError(
+          "The length of all the messages put together is more than the "
+          "limit.",
+          "BatchRequestTooLong");
+  }
 }
 
 restinio::request_handling_status_t resp_ok(Serde* serde,
                                             restinio::request_handle_t req,
                                             std::string body) {
-  return req->create_response()
-      .append_header(restinio::http_field::content_type, serde->contentType())
-      .set_body(std::move(body))
-      .done();
+  auto res = req->create_response();
+  res.append_header(restinio::http_field::content_type, serde->contentType());
+  // RPC v2 responses name their protocol like the requests do
+  if (serde->contentType() == CBOR_CONTENT_TYPE) {
+    res.append_header(SMITHY_PROTOCOL, RPC_V2_CBOR);
+  }
+  return res.set_body(std::move(body)).done();
+}
+
+restinio::request_handling_status_t resp_empty(Serde* serde,
+                                               restinio::request_handle_t req) {
+  auto res = EmptyResponse{};
+  return resp_ok(serde, req, serde->serialize(&res));
 }
 
 restinio::request_handling_status_t resp_err(Serde* serde,
                                              restinio::request_handle_t req,
                                              Error err) {
-  return req->create_response(err.status)
-      .append_header(restinio::http_field::content_type, serde->contentType())
-      .set_body(serde->serialize(&err))
-      .done();
+  auto res = req->create_response(err.status);
+  res.append_header(restinio::http_field::content_type, serde->contentType());
+  if (serde->contentType() == CBOR_CONTENT_TYPE) {
+    res.append_header(SMITHY_PROTOCOL, RPC_V2_CBOR);
+  }
+  return res.set_body(serde->serialize(&err)).done();
 }
 
 AWSProtocol extract_protocol(restinio::http_request_header_t* headers) {
+  auto protocol = headers->opt_value_of(SMITHY_PROTOCOL);
+  if (protocol.has_value() && protocol.value() == RPC_V2_CBOR) {
+    return SmithyRpcV2Cbor;
+  }
   auto content_type = headers->opt_value_of(restinio::http_field::content_type);
   if (content_type.has_value()) {
     if (content_type.value() == AWS_JSON_PROTOCOL_1_0)
@@ -308,4 +631,52 @@ std::optional<std::string> extract_queue_name(
   return {};
 }
 
+std::optional<size_t> request_shard(Serde* serde,
+                                    restinio::http_request_header_t* headers,
+                                    restinio::request_handle_t req,
+                                    size_t shards) {
+  auto action = extract_action(headers);
+  if (!action.has_value()) {
+    return {};
+  }
+  auto input = req->body();
+  std::optional<std::string> name;
+  switch (action.value()) {
+    case SQSListQueues:
+      return {};
+    case SQSCreateQueue:
+    case SQSGetQueueUrl:
+      name = serde->read_string_member(input, "QueueName");
+      break;
+    case SQSStartMessageMoveTask:
+    case SQSListMessageMoveTasks:
+      // tasks run on the shard of their source queue
+      name = serde->read_string_member(input, "SourceArn");
+      break;
+    case SQSCancelMessageMoveTask: {
+      auto task_handle = serde->read_string_member(input, "TaskHandle");
+      if (!task_handle.has_value()) {
+        return {};
+      }
+      return move_task_shard(task_handle.value(), shards);
+    }
+    case FullQueueData:
+    case PurgeQueue:
+      name = extract_queue_name(headers);
+      break;
+    default:
+      name = serde->read_string_member(input, "QueueUrl");
+  }
+  if (!name.has_value()) {
+    return {};
+  }
+  // queue URLs and ARNs end with the name
+  auto qname = std::string_view(name.value());
+  auto pos = qname.find_last_of("/:");
+  if (pos != std::string_view::npos) {
+    qname = qname.substr(pos + 1);
+  }
+  return shard_of(qname, shards);
+}
+
 }  // namespace sqscpp
@@ -3,23 +3,31 @@
 
 #include <restinio/core.hpp>
 
+#include "mailbox.hpp"
 #include "protocol.hpp"
 #include "serde.hpp"
 #include "sqs.hpp"
 
 namespace sqscpp {
-enum AWSProtocol { AWSQueryProtocol, AWSJsonProtocol1_0, TextHtml };
+enum AWSProtocol {
+  AWSQueryProtocol,
+  AWSJsonProtocol1_0,
+  SmithyRpcV2Cbor,
+  TextHtml
+};
 enum SQSAction {
   SQSListQueues,
   SQSAddPermission,
   SQSChangeMessageVisibilityBatch,
   SQSChangeMessageVisibility,
+  SQSCancelMessageMoveTask,
   SQSCreateQueue,
   SQSDeleteMessageBatch,
   SQSDeleteMessage,
   SQSDeleteQueue,
   SQSGetQueueUrl,
   SQSListDeadLetterSourceQueues,
+  SQSListMessageMoveTasks,
   SQSListQueueTags,
   SQSPurgeQueue,
   SQSGetQueueAttributes,
@@ -28,6 +36,7 @@ enum SQSAction {
   SQSRemovePermission,
   SQSSendMessageBatch,
   SQSSendMessage,
+  SQSStartMessageMoveTask,
   SQSTagQueue,
   SQSUntagQueue,
   // off AWS SQS, for GUI
@@ -38,6 +47,10 @@ enum SQSAction {
 const std::string AWS_JSON_PROTOCOL_1_0 = "application/x-amz-json-1.0";
 const std::string AWS_QUERY_PROTOCOL = "text/xml";
 const std::string TEXT_HTML = "text/html";
+const std::string CBOR_CONTENT_TYPE = "application/cbor";
+const std::string SMITHY_PROTOCOL = "smithy-protocol";
+const std::string RPC_V2_CBOR = "rpc-v2-cbor";
+const std::string RPC_V2_OPERATION_PATH = "/service/AmazonSQS/operation/";
 const std::string AWS_TRACE_ID = "x-amzn-trace-id";
 const std::string AWS_TARGET = "x-amz-target";
 const std::string QUEUE_NAME = "x-queue-name";
@@ -45,12 +58,14 @@ const std::map<std::string, SQSAction> AWS_SQS_ACTIONS = {
     {"AmazonSQS.AddPermission", SQSAddPermission},
     {"AmazonSQS.ChangeMessageVisibilityBatch", SQSChangeMessageVisibilityBatch},
     {"AmazonSQS.ChangeMessageVisibility", SQSChangeMessageVisibility},
+    {"AmazonSQS.CancelMessageMoveTask", SQSCancelMessageMoveTask},
     {"AmazonSQS.CreateQueue", SQSCreateQueue},
     {"AmazonSQS.DeleteMessageBatch", SQSDeleteMessageBatch},
     {"AmazonSQS.DeleteMessage", SQSDeleteMessage},
     {"AmazonSQS.DeleteQueue", SQSDeleteQueue},
     {"AmazonSQS.GetQueueUrl", SQSGetQueueUrl},
     {"AmazonSQS.ListDeadLetterSourceQueues", SQSListDeadLetterSourceQueues},
+    {"AmazonSQS.ListMessageMoveTasks", SQSListMessageMoveTasks},
     {"AmazonSQS.ListQueueTags", SQSListQueueTags},
     {"AmazonSQS.ListQueues", SQSListQueues},
     {"AmazonSQS.PurgeQueue", SQSPurgeQueue},
@@ -60,19 +75,37 @@ const std::map<std::string, SQSAction> AWS_SQS_ACTIONS = {
     {"AmazonSQS.RemovePermission", SQSRemovePermission},
     {"AmazonSQS.SendMessageBatch", SQSSendMessageBatch},
     {"AmazonSQS.SendMessage", SQSSendMessage},
+    {"AmazonSQS.StartMessageMoveTask", SQSStartMessageMoveTask},
     {"AmazonSQS.TagQueue", SQSTagQueue},
     {"AmazonSQS.UntagQueue", SQSUntagQueue},
     {"FullQueueData", FullQueueData},
     {"PurgeQueue", PurgeQueue}};
 
+// Handles a request whose action is named by its AWS_TARGET header.
+using QueryHandler = std::function<restinio::request_handling_status_t(
+    Serde*, restinio::http_request_header_t*, restinio::request_handle_t)>;
+
+std::function<restinio::request_handling_status_t(restinio::request_handle_t)>
+handler_factory(SQS* sqs, JsonSerde* serde, CborSerde* cbor_serde,
+                HtmlSerde* html_serde);
+// Handles the requests accepted by shard `index`, those for queues of other
+// shards are posted to their mailbox and answered from there.
 std::function<restinio::request_handling_status_t(restinio::request_handle_t)>
-handler_factory(SQS* sqs, JsonSerde* serde, HtmlSerde* html_serde);
+shard_handler_factory(std::vector<Shard>* shards, size_t index,
+                      JsonSerde* serde, CborSerde* cbor_serde,
+                      HtmlSerde* html_serde);
 restinio::request_handling_status_t sqs_query_handler(
     SQS* sqs, Serde* serde, restinio::http_request_header_t* headers,
     restinio::request_handle_t req);
+restinio::request_handling_status_t shard_query_handler(
+    std::vector<Shard>* shards, size_t index, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req);
+restinio::request_handling_status_t cbor_query_handler(
+    const QueryHandler& handler, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req);
 restinio::request_handling_status_t html_query_handler(
-    SQS* sqs, Serde* serde, restinio::http_request_header_t* headers,
-    restinio::request_handle_t req);
+    const QueryHandler& handler, Serde* serde,
+    restinio::http_request_header_t* headers, restinio::request_handle_t req);
 
 AWSProtocol extract_protocol(restinio::http_request_header_t* headers);
 std::optional<SQSAction> extract_action(
@@ -81,10 +114,19 @@ std::optional<std::string> extract_trace_id(
     restinio::http_request_header_t* headers);
 std::optional<std::string> extract_queue_name(
     restinio::http_request_header_t* headers);
+// Index of the shard owning the queue or move task a request is for, nothing
+// for requests any shard can answer.
+std::optional<size_t> request_shard(Serde* serde,
+                                    restinio::http_request_header_t* headers,
+                                    restinio::request_handle_t req,
+                                    size_t shards);
 
+Error batch_error(BatchStatus status);
 restinio::request_handling_status_t resp_ok(Serde* serde,
                                             restinio::request_handle_t req,
                                             std::string body);
+restinio::request_handling_status_t resp_empty(Serde* serde,
+                                               restinio::request_handle_t req);
 restinio::request_handling_status_t resp_err(Serde* serde,
                                              restinio::request_handle_t req,
                                              Error err);
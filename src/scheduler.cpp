@@ -0,0 +1,39 @@
+#include "scheduler.hpp"
+
+namespace sqscpp {
+Scheduler::Scheduler()
+    : next_seq(0), worker([this](std::stop_token stop) { run(stop); }) {}
+
+void Scheduler::schedule(Clock::time_point at, std::function<void()> fn) {
+  {
+    std::lock_guard lock(mtx);
+    tasks.push(Task{at, next_seq++, std::move(fn)});
+  }
+  cv.notify_all();
+}
+
+void Scheduler::run(std::stop_token stop) {
+  std::unique_lock lock(mtx);
+  while (!stop.stop_requested()) {
+    if (tasks.empty()) {
+      cv.wait(lock, stop, [this]() { return !tasks.empty(); });
+      continue;
+    }
+
+    auto at = tasks.top().at;
+    if (Clock::now() < at) {
+      // woken early by a new task or stop, re-evaluate the earliest one
+      cv.wait_until(lock, stop, at, [this, at]() {
+        return !tasks.empty() && tasks.top().at < at;
+      });
+      continue;
+    }
+
+    auto fn = std::move(const_cast<Task&>(tasks.top()).fn);
+    tasks.pop();
+    lock.unlock();
+    fn();
+    lock.lock();
+  }
+}
+}  // namespace sqscpp
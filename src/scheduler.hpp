@@ -0,0 +1,46 @@
+#ifndef SQSCPP_SCHEDULER_H
+#define SQSCPP_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace sqscpp {
+using Clock = std::chrono::system_clock;
+
+// Runs tasks at a given time on a single background thread. Tasks run in
+// order of their time and must not block, long running work belongs on its
+// own thread.
+class Scheduler {
+ private:
+  struct Task {
+    Clock::time_point at;
+    uint64_t seq;
+    std::function<void()> fn;
+  };
+  // orders the heap by earliest time, then by submission
+  struct RunsLater {
+    bool operator()(const Task& a, const Task& b) const {
+      return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+    }
+  };
+
+  std::mutex mtx;
+  std::condition_variable_any cv;
+  std::priority_queue<Task, std::vector<Task>, RunsLater> tasks;
+  uint64_t next_seq;
+  std::jthread worker;
+
+  void run(std::stop_token stop);
+
+ public:
+  Scheduler();
+  void schedule(Clock::time_point at, std::function<void()> fn);
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_SCHEDULER_H
@@ -1,5 +1,10 @@
 #include "serde.hpp"
 
+#include <algorithm>
+#include <limits>
+
+#include "cbor.hpp"
+
 namespace sqscpp {
 std::optional<std::map<std::string, std::string>> JsonSerde::parse_dict(
     json j) {
@@ -33,6 +38,12 @@ std::optional<std::string> JsonSerde::parse_non_empty_string(json j) {
 
 std::optional<long> JsonSerde::parse_long(json j) {
   if (j == nullptr || !j.is_number_integer()) return {};
+  // unsigned values past the range of long saturate instead of wrapping
+  if (j.is_number_unsigned() &&
+      j.get<json::number_unsigned_t>() >
+          (json::number_unsigned_t)std::numeric_limits<long>::max()) {
+    return std::numeric_limits<long>::max();
+  }
   try {
     return j;
   } catch (json::type_error& e) {
@@ -41,12 +52,74 @@ std::optional<long> JsonSerde::parse_long(json j) {
 }
 
 std::optional<int> JsonSerde::parse_int(json j) {
-  if (j == nullptr || !j.is_number_integer()) return {};
-  try {
-    return j;
-  } catch (json::type_error& e) {
-    return {};
+  auto value = parse_long(j);
+  if (!value.has_value()) return {};
+  // saturates like read_int_param, so that the range check of the parameter
+  // rejects values past the range of int
+  return (int)std::clamp<long>(value.value(), std::numeric_limits<int>::min(),
+                               std::numeric_limits<int>::max());
+}
+
+namespace {
+// Stops the parse at the string value of a top level member.
+struct MemberReader {
+  std::string_view member;
+  std::optional<std::string> value;
+  int depth = 0;
+  bool wanted = false;
+
+  // a value other than the wanted string ends the search for this key
+  bool other() {
+    wanted = false;
+    return true;
+  }
+  bool null() { return other(); }
+  bool boolean(bool) { return other(); }
+  bool number_integer(json::number_integer_t) { return other(); }
+  bool number_unsigned(json::number_unsigned_t) { return other(); }
+  bool number_float(json::number_float_t, const json::string_t&) {
+    return other();
   }
+  bool binary(json::binary_t&) { return other(); }
+  bool string(json::string_t& str) {
+    if (wanted) {
+      value = std::move(str);
+      return false;
+    }
+    return true;
+  }
+  bool key(json::string_t& key) {
+    wanted = depth == 1 && key == member;
+    return true;
+  }
+  bool start_object(std::size_t) {
+    depth++;
+    return other();
+  }
+  bool end_object() {
+    depth--;
+    return true;
+  }
+  bool start_array(std::size_t) {
+    depth++;
+    return other();
+  }
+  bool end_array() {
+    depth--;
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&,
+                   const nlohmann::detail::exception&) {
+    return false;
+  }
+};
+}  // namespace
+
+std::optional<std::string> JsonSerde::read_string_member(
+    std::string& str, std::string_view member) {
+  MemberReader reader{member};
+  json::sax_parse(str, &reader);
+  return reader.value;
 }
 
 std::string JsonSerde::serialize(Error* err) {
@@ -63,11 +136,13 @@ std::string JsonSerde::serialize(CreateQueueResponse* res) {
 
 std::string JsonSerde::serialize(ListQueuesResponse* res) {
   json j;
-  std::vector<std::string> urls;
-  for (const auto& info : *(res->queue_urls)) {
+  auto& urls = j["QueueUrls"] = json::array();
+  for (const auto& info : res->queues) {
     urls.push_back(info.queue_url);
   }
-  j["QueueUrls"] = urls;
+  if (res->next_token.has_value()) {
+    j["NextToken"] = res->next_token.value();
+  }
   return j.dump();
 }
 
@@ -83,28 +158,96 @@ std::string JsonSerde::serialize(ListQueueTagsResponse* res) {
   return j.dump();
 }
 
+std::string JsonSerde::serialize(GetQueueAttributesResponse* res) {
+  json j;
+  j["Attributes"] = *(res->attributes);
+  return j.dump();
+}
+
 std::string JsonSerde::serialize(ReceivedMessageResponse* res) {
   json j;
   j["MessageId"] = res->message_id;
   j["ReceiptHandle"] = res->receipt_handle;
   j["MD5OfBody"] = res->md5_of_body;
-  j["Body"] = res->body;
+  j["Body"] = res->body.view();
+  if (res->receive_count > 0) {
+    j["Attributes"]["ApproximateReceiveCount"] =
+        std::to_string(res->receive_count);
+  }
   return j.dump();
 }
 
+// Writes `str` as a JSON string the same way json::dump does.
+static void write_json_string(std::string& out, std::string_view str) {
+  static const char* HEX = "0123456789abcdef";
+  out.push_back('"');
+  for (unsigned char c : str) {
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\b':
+        out.append("\\b");
+        break;
+      case '\f':
+        out.append("\\f");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        if (c < 0x20) {
+          out.append("\\u00");
+          out.push_back(HEX[c >> 4]);
+          out.push_back(HEX[c & 0xf]);
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
 std::string JsonSerde::serialize(ReceivedMessagesResponse* res) {
-  json j;
-  std::vector<json> messages;
+  // written by hand so that bodies are escaped straight into the response
+  // instead of being copied into a json document first
+  size_t size = 16;
   for (const auto& msg : res->messages) {
-    json m;
-    m["MessageId"] = msg.message_id;
-    m["ReceiptHandle"] = msg.receipt_handle;
-    m["MD5OfBody"] = msg.md5_of_body;
-    m["Body"] = msg.body;
-    messages.push_back(m);
-  }
-  j["Messages"] = messages;
-  return j.dump();
+    size += msg.body.size() + 160;
+  }
+
+  std::string out;
+  out.reserve(size);
+  out.append("{\"Messages\":[");
+  for (size_t i = 0; i < res->messages.size(); i++) {
+    const auto& msg = res->messages[i];
+    out.append(i == 0 ? "{" : ",{");
+    if (msg.receive_count > 0) {
+      out.append("\"Attributes\":{\"ApproximateReceiveCount\":\"");
+      out.append(std::to_string(msg.receive_count));
+      out.append("\"},");
+    }
+    out.append("\"Body\":");
+    write_json_string(out, msg.body.view());
+    out.append(",\"MD5OfBody\":");
+    write_json_string(out, msg.md5_of_body);
+    out.append(",\"MessageId\":");
+    write_json_string(out, msg.message_id);
+    out.append(",\"ReceiptHandle\":");
+    write_json_string(out, msg.receipt_handle);
+    out.push_back('}');
+  }
+  out.append("]}");
+  return out;
 }
 
 std::string JsonSerde::serialize(SendMessageResponse* res) {
@@ -114,6 +257,87 @@ std::string JsonSerde::serialize(SendMessageResponse* res) {
   return j.dump();
 }
 
+static json serialize_failed(std::vector<BatchResultErrorEntry>& failed) {
+  json entries = json::array();
+  for (const auto& entry : failed) {
+    entries.push_back({{"Id", entry.id},
+                       {"SenderFault", entry.sender_fault},
+                       {"Code", entry.code},
+                       {"Message", entry.message}});
+  }
+  return entries;
+}
+
+std::string JsonSerde::serialize(SendMessageBatchResponse* res) {
+  json j;
+  j["Successful"] = json::array();
+  for (const auto& entry : res->successful) {
+    j["Successful"].push_back(
+        {{"Id", entry.id},
+         {"MessageId", entry.message_id},
+         {"MD5OfMessageBody", entry.md5_of_message_body}});
+  }
+  j["Failed"] = serialize_failed(res->failed);
+  return j.dump();
+}
+
+std::string JsonSerde::serialize(BatchResponse* res) {
+  json j;
+  j["Successful"] = json::array();
+  for (const auto& id : res->successful) {
+    j["Successful"].push_back({{"Id", id}});
+  }
+  j["Failed"] = serialize_failed(res->failed);
+  return j.dump();
+}
+
+std::string JsonSerde::serialize(ListDeadLetterSourceQueuesResponse* res) {
+  json j;
+  j["queueUrls"] = res->queue_urls;
+  return j.dump();
+}
+
+std::string JsonSerde::serialize(StartMessageMoveTaskResponse* res) {
+  json j;
+  j["TaskHandle"] = res->task_handle;
+  return j.dump();
+}
+
+std::string JsonSerde::serialize(CancelMessageMoveTaskResponse* res) {
+  json j;
+  j["ApproximateNumberOfMessagesMoved"] =
+      res->approximate_number_of_messages_moved;
+  return j.dump();
+}
+
+std::string JsonSerde::serialize(ListMessageMoveTasksResponse* res) {
+  json j;
+  j["Results"] = json::array();
+  for (const auto& result : res->results) {
+    json r;
+    if (!result.task_handle.empty()) {
+      r["TaskHandle"] = result.task_handle;
+    }
+    r["Status"] = result.status;
+    r["SourceArn"] = result.source_arn;
+    r["DestinationArn"] = result.destination_arn;
+    if (result.max_number_of_messages_per_second.has_value()) {
+      r["MaxNumberOfMessagesPerSecond"] =
+          result.max_number_of_messages_per_second.value();
+    }
+    r["ApproximateNumberOfMessagesMoved"] =
+        result.approximate_number_of_messages_moved;
+    r["ApproximateNumberOfMessagesToMove"] =
+        result.approximate_number_of_messages_to_move;
+    if (!result.failure_reason.empty()) {
+      r["FailureReason"] = result.failure_reason;
+    }
+    r["StartedTimestamp"] = result.started_timestamp;
+    j["Results"].push_back(r);
+  }
+  return j.dump();
+}
+
 std::optional<std::unique_ptr<CreateQueueInput>>
 JsonSerde::deserialize_create_queue_input(std::string& str) {
   try {
@@ -143,6 +367,24 @@ JsonSerde::deserialize_get_queue_url_input(std::string& str) {
   }
 }
 
+std::optional<std::unique_ptr<ListQueuesInput>>
+JsonSerde::deserialize_list_queues_input(std::string& str) {
+  // every parameter is optional, clients may send no body at all
+  if (str.empty()) {
+    return std::make_unique<ListQueuesInput>(std::nullopt, std::nullopt,
+                                             std::nullopt);
+  }
+  try {
+    json j = json::parse(str);
+
+    return std::make_unique<ListQueuesInput>(
+        parse_non_empty_string(j["QueueNamePrefix"]),
+        parse_int(j["MaxResults"]), parse_non_empty_string(j["NextToken"]));
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
 std::optional<std::unique_ptr<DeleteQueueInput>>
 JsonSerde::deserialize_delete_queue_input(std::string& str) {
   try {
@@ -205,6 +447,39 @@ JsonSerde::deserialize_untag_queue_input(std::string& str) {
   }
 }
 
+std::optional<std::unique_ptr<SetQueueAttributesInput>>
+JsonSerde::deserialize_set_queue_attributes_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+
+    auto attrs = parse_dict(j["Attributes"]);
+    if (!attrs.has_value()) return {};
+
+    return std::make_unique<SetQueueAttributesInput>(qurl.value(),
+                                                     attrs.value());
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<GetQueueAttributesInput>>
+JsonSerde::deserialize_get_queue_attributes_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+
+    return std::make_unique<GetQueueAttributesInput>(
+        qurl.value(), parse_list(j["AttributeNames"]));
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
 std::optional<std::unique_ptr<SendMessageInput>>
 JsonSerde::deserialize_send_message_input(std::string& str) {
   try {
@@ -217,8 +492,9 @@ JsonSerde::deserialize_send_message_input(std::string& str) {
     if (!msg.has_value()) return {};
 
     return std::make_unique<SendMessageInput>(
-        qurl.value(), msg.value(), parse_long(j["DelaySeconds"]),
-        parse_non_empty_string(j["MessageDeduplicationId"]));
+        qurl.value(), std::move(msg.value()), parse_long(j["DelaySeconds"]),
+        parse_non_empty_string(j["MessageDeduplicationId"]),
+        parse_non_empty_string(j["MessageGroupId"]));
   } catch (json::parse_error& e) {
     return {};
   }
@@ -238,6 +514,65 @@ JsonSerde::deserialize_purge_queue_input(std::string& str) {
   }
 }
 
+std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+JsonSerde::deserialize_list_dead_letter_source_queues_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+
+    return std::make_unique<ListDeadLetterSourceQueuesInput>(qurl.value());
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+JsonSerde::deserialize_start_message_move_task_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto source_arn = parse_non_empty_string(j["SourceArn"]);
+    if (!source_arn.has_value()) return {};
+
+    return std::make_unique<StartMessageMoveTaskInput>(
+        source_arn.value(), parse_non_empty_string(j["DestinationArn"]),
+        parse_long(j["MaxNumberOfMessagesPerSecond"]));
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+JsonSerde::deserialize_cancel_message_move_task_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto task_handle = parse_non_empty_string(j["TaskHandle"]);
+    if (!task_handle.has_value()) return {};
+
+    return std::make_unique<CancelMessageMoveTaskInput>(task_handle.value());
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+JsonSerde::deserialize_list_message_move_tasks_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto source_arn = parse_non_empty_string(j["SourceArn"]);
+    if (!source_arn.has_value()) return {};
+
+    return std::make_unique<ListMessageMoveTasksInput>(
+        source_arn.value(), parse_int(j["MaxResults"]));
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
 std::optional<std::unique_ptr<ReceiveMessageInput>>
 JsonSerde::deserialize_receive_message_input(std::string& str) {
   try {
@@ -273,6 +608,897 @@ JsonSerde::deserialize_delete_message_input(std::string& str) {
   }
 }
 
+std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+JsonSerde::deserialize_change_message_visibility_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+
+    auto receipt_handle = parse_non_empty_string(j["ReceiptHandle"]);
+    if (!receipt_handle.has_value()) return {};
+
+    auto visibility_timeout = parse_long(j["VisibilityTimeout"]);
+    if (!visibility_timeout.has_value()) return {};
+
+    return std::make_unique<ChangeMessageVisibilityInput>(
+        qurl.value(), receipt_handle.value(), visibility_timeout.value());
+  } catch (json::parse_error& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<SendMessageBatchInput>>
+JsonSerde::deserialize_send_message_batch_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+    if (!j["Entries"].is_array()) return {};
+
+    std::vector<SendMessageBatchEntry> entries;
+    for (auto& e : j["Entries"]) {
+      auto id = parse_non_empty_string(e["Id"]);
+      if (!id.has_value()) return {};
+
+      auto msg = parse_non_empty_string(e["MessageBody"]);
+      if (!msg.has_value()) return {};
+
+      entries.push_back(SendMessageBatchEntry{
+          id.value(), std::move(msg.value()), parse_long(e["DelaySeconds"]),
+          parse_non_empty_string(e["MessageDeduplicationId"]),
+          parse_non_empty_string(e["MessageGroupId"])});
+    }
+    return std::make_unique<SendMessageBatchInput>(qurl.value(),
+                                                   std::move(entries));
+  } catch (json::exception& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+JsonSerde::deserialize_delete_message_batch_input(std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+    if (!j["Entries"].is_array()) return {};
+
+    std::vector<DeleteMessageBatchEntry> entries;
+    for (auto& e : j["Entries"]) {
+      auto id = parse_non_empty_string(e["Id"]);
+      if (!id.has_value()) return {};
+
+      auto receipt_handle = parse_non_empty_string(e["ReceiptHandle"]);
+      if (!receipt_handle.has_value()) return {};
+
+      entries.push_back(
+          DeleteMessageBatchEntry{id.value(), receipt_handle.value()});
+    }
+    return std::make_unique<DeleteMessageBatchInput>(qurl.value(),
+                                                     std::move(entries));
+  } catch (json::exception& e) {
+    return {};
+  }
+}
+
+std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+JsonSerde::deserialize_change_message_visibility_batch_input(
+    std::string& str) {
+  try {
+    json j = json::parse(str);
+
+    auto qurl = parse_non_empty_string(j["QueueUrl"]);
+    if (!qurl.has_value()) return {};
+    if (!j["Entries"].is_array()) return {};
+
+    std::vector<ChangeMessageVisibilityBatchEntry> entries;
+    for (auto& e : j["Entries"]) {
+      auto id = parse_non_empty_string(e["Id"]);
+      if (!id.has_value()) return {};
+
+      auto receipt_handle = parse_non_empty_string(e["ReceiptHandle"]);
+      if (!receipt_handle.has_value()) return {};
+
+      auto visibility_timeout = parse_long(e["VisibilityTimeout"]);
+      if (!visibility_timeout.has_value()) return {};
+
+      entries.push_back(ChangeMessageVisibilityBatchEntry{
+          id.value(), receipt_handle.value(), visibility_timeout.value()});
+    }
+    return std::make_unique<ChangeMessageVisibilityBatchInput>(
+        qurl.value(), std::move(entries));
+  } catch (json::exception& e) {
+    return {};
+  }
+}
+
+// Required string members, like optional ones, do not count when empty.
+static std::optional<std::string> non_empty(std::optional<std::string> str) {
+  if (!str.has_value() || str->empty()) return {};
+  return str;
+}
+
+// Reads an int parameter. Values past the range of int saturate rather than
+// wrap, so that the range check of the parameter rejects them.
+static std::optional<int> read_int_param(CborReader& r) {
+  auto value = r.read_int();
+  if (!value.has_value()) return {};
+  return (int)std::clamp<long>(value.value(), std::numeric_limits<int>::min(),
+                               std::numeric_limits<int>::max());
+}
+
+static std::optional<std::map<std::string, std::string>> read_dict(
+    CborReader& r) {
+  std::map<std::string, std::string> dict;
+  auto read = r.read_map([&r, &dict](std::string_view key) {
+    auto value = r.read_string();
+    if (value.has_value()) {
+      dict.emplace(key, std::move(value.value()));
+    }
+  });
+  if (!read) return {};
+  return dict;
+}
+
+static std::optional<std::vector<std::string>> read_list(CborReader& r) {
+  std::vector<std::string> list;
+  auto read = r.read_array([&r, &list]() {
+    auto value = r.read_string();
+    if (value.has_value()) {
+      list.push_back(std::move(value.value()));
+    }
+  });
+  if (!read) return {};
+  return list;
+}
+
+static void write_dict(CborWriter& w,
+                       const std::map<std::string, std::string>& dict) {
+  w.write_map(dict.size());
+  for (const auto& [key, value] : dict) {
+    w.write_string(key);
+    w.write_string(value);
+  }
+}
+
+static void write_failed(CborWriter& w,
+                         const std::vector<BatchResultErrorEntry>& failed) {
+  w.write_string("Failed");
+  w.write_array(failed.size());
+  for (const auto& entry : failed) {
+    w.write_map(4);
+    w.write_string("Id");
+    w.write_string(entry.id);
+    w.write_string("SenderFault");
+    w.write_bool(entry.sender_fault);
+    w.write_string("Code");
+    w.write_string(entry.code);
+    w.write_string("Message");
+    w.write_string(entry.message);
+  }
+}
+
+std::optional<std::string> CborSerde::read_string_member(
+    std::string& str, std::string_view member) {
+  CborReader r(str);
+  std::optional<std::string> value;
+  r.read_map([&](std::string_view key) {
+    if (key == member && !value.has_value()) {
+      value = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  return value;
+}
+
+std::string CborSerde::serialize(Error* err) {
+  CborWriter w;
+  // SDKs pick the error to raise by the shape id in __type
+  w.write_map(err->type.empty() ? 1 : 2);
+  if (!err->type.empty()) {
+    w.write_string("__type");
+    w.write_string(SQS_SHAPE_NAMESPACE + err->type);
+  }
+  w.write_string("message");
+  w.write_string(err->message);
+  return w.take();
+}
+
+std::string CborSerde::serialize(EmptyResponse* res) {
+  CborWriter w;
+  w.write_map(0);
+  return w.take();
+}
+
+std::string CborSerde::serialize(CreateQueueResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("QueueUrl");
+  w.write_string(res->queue_url);
+  return w.take();
+}
+
+std::string CborSerde::serialize(ListQueuesResponse* res) {
+  CborWriter w;
+  w.write_map(res->next_token.has_value() ? 2 : 1);
+  w.write_string("QueueUrls");
+  w.write_array(res->queues.size());
+  for (const auto& info : res->queues) {
+    w.write_string(info.queue_url);
+  }
+  if (res->next_token.has_value()) {
+    w.write_string("NextToken");
+    w.write_string(res->next_token.value());
+  }
+  return w.take();
+}
+
+std::string CborSerde::serialize(GetQueueUrlResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("QueueUrl");
+  w.write_string(res->queue_url);
+  return w.take();
+}
+
+std::string CborSerde::serialize(ListQueueTagsResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("Tags");
+  write_dict(w, *(res->tags));
+  return w.take();
+}
+
+std::string CborSerde::serialize(GetQueueAttributesResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("Attributes");
+  write_dict(w, *(res->attributes));
+  return w.take();
+}
+
+static void write_message(CborWriter& w, const ReceivedMessageResponse& msg) {
+  w.write_map(msg.receive_count > 0 ? 5 : 4);
+  if (msg.receive_count > 0) {
+    w.write_string("Attributes");
+    w.write_map(1);
+    w.write_string("ApproximateReceiveCount");
+    w.write_string(std::to_string(msg.receive_count));
+  }
+  w.write_string("Body");
+  w.write_string(msg.body.view());
+  w.write_string("MD5OfBody");
+  w.write_string(msg.md5_of_body);
+  w.write_string("MessageId");
+  w.write_string(msg.message_id);
+  w.write_string("ReceiptHandle");
+  w.write_string(msg.receipt_handle);
+}
+
+std::string CborSerde::serialize(ReceivedMessageResponse* res) {
+  CborWriter w;
+  w.reserve(res->body.size() + 192);
+  write_message(w, *res);
+  return w.take();
+}
+
+std::string CborSerde::serialize(ReceivedMessagesResponse* res) {
+  // bodies are copied once, straight into the response
+  size_t size = 16;
+  for (const auto& msg : res->messages) {
+    size += msg.body.size() + 192;
+  }
+
+  CborWriter w;
+  w.reserve(size);
+  w.write_map(1);
+  w.write_string("Messages");
+  w.write_array(res->messages.size());
+  for (const auto& msg : res->messages) {
+    write_message(w, msg);
+  }
+  return w.take();
+}
+
+std::string CborSerde::serialize(SendMessageResponse* res) {
+  CborWriter w;
+  w.write_map(2);
+  w.write_string("MessageId");
+  w.write_string(res->message_id);
+  w.write_string("MD5OfMessageBody");
+  w.write_string(res->md5_of_message_body);
+  return w.take();
+}
+
+std::string CborSerde::serialize(SendMessageBatchResponse* res) {
+  CborWriter w;
+  w.write_map(2);
+  w.write_string("Successful");
+  w.write_array(res->successful.size());
+  for (const auto& entry : res->successful) {
+    w.write_map(3);
+    w.write_string("Id");
+    w.write_string(entry.id);
+    w.write_string("MessageId");
+    w.write_string(entry.message_id);
+    w.write_string("MD5OfMessageBody");
+    w.write_string(entry.md5_of_message_body);
+  }
+  write_failed(w, res->failed);
+  return w.take();
+}
+
+std::string CborSerde::serialize(BatchResponse* res) {
+  CborWriter w;
+  w.write_map(2);
+  w.write_string("Successful");
+  w.write_array(res->successful.size());
+  for (const auto& id : res->successful) {
+    w.write_map(1);
+    w.write_string("Id");
+    w.write_string(id);
+  }
+  write_failed(w, res->failed);
+  return w.take();
+}
+
+std::string CborSerde::serialize(ListDeadLetterSourceQueuesResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("queueUrls");
+  w.write_array(res->queue_urls.size());
+  for (const auto& qurl : res->queue_urls) {
+    w.write_string(qurl);
+  }
+  return w.take();
+}
+
+std::string CborSerde::serialize(StartMessageMoveTaskResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("TaskHandle");
+  w.write_string(res->task_handle);
+  return w.take();
+}
+
+std::string CborSerde::serialize(CancelMessageMoveTaskResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("ApproximateNumberOfMessagesMoved");
+  w.write_int(res->approximate_number_of_messages_moved);
+  return w.take();
+}
+
+std::string CborSerde::serialize(ListMessageMoveTasksResponse* res) {
+  CborWriter w;
+  w.write_map(1);
+  w.write_string("Results");
+  w.write_array(res->results.size());
+  for (const auto& result : res->results) {
+    auto has_rate = result.max_number_of_messages_per_second.has_value();
+    w.write_map(6 + !result.task_handle.empty() + has_rate +
+                !result.failure_reason.empty());
+    if (!result.task_handle.empty()) {
+      w.write_string("TaskHandle");
+      w.write_string(result.task_handle);
+    }
+    w.write_string("Status");
+    w.write_string(result.status);
+    w.write_string("SourceArn");
+    w.write_string(result.source_arn);
+    w.write_string("DestinationArn");
+    w.write_string(result.destination_arn);
+    if (has_rate) {
+      w.write_string("MaxNumberOfMessagesPerSecond");
+      w.write_int(result.max_number_of_messages_per_second.value());
+    }
+    w.write_string("ApproximateNumberOfMessagesMoved");
+    w.write_int(result.approximate_number_of_messages_moved);
+    w.write_string("ApproximateNumberOfMessagesToMove");
+    w.write_int(result.approximate_number_of_messages_to_move);
+    if (!result.failure_reason.empty()) {
+      w.write_string("FailureReason");
+      w.write_string(result.failure_reason);
+    }
+    w.write_string("StartedTimestamp");
+    w.write_int(result.started_timestamp);
+  }
+  return w.take();
+}
+
+std::optional<std::unique_ptr<CreateQueueInput>>
+CborSerde::deserialize_create_queue_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qname;
+  std::optional<std::map<std::string, std::string>> attrs;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueName") {
+      qname = r.read_string();
+    } else if (key == "Attributes") {
+      attrs = read_dict(r);
+    } else {
+      r.skip();
+    }
+  });
+  qname = non_empty(qname);
+  if (!r.at_end() || !qname.has_value()) return {};
+
+  return std::make_unique<CreateQueueInput>(qname.value(), attrs);
+}
+
+std::optional<std::unique_ptr<GetQueueUrlInput>>
+CborSerde::deserialize_get_queue_url_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qname;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueName") {
+      qname = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  qname = non_empty(qname);
+  if (!r.at_end() || !qname.has_value()) return {};
+
+  return std::make_unique<GetQueueUrlInput>(qname.value());
+}
+
+std::optional<std::unique_ptr<ListQueuesInput>>
+CborSerde::deserialize_list_queues_input(std::string& str) {
+  // every parameter is optional, clients may send no body at all
+  if (str.empty()) {
+    return std::make_unique<ListQueuesInput>(std::nullopt, std::nullopt,
+                                             std::nullopt);
+  }
+  CborReader r(str);
+  std::optional<std::string> prefix;
+  std::optional<int> max_results;
+  std::optional<std::string> next_token;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueNamePrefix") {
+      prefix = r.read_string();
+    } else if (key == "MaxResults") {
+      max_results = read_int_param(r);
+    } else if (key == "NextToken") {
+      next_token = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  if (!r.at_end()) return {};
+
+  return std::make_unique<ListQueuesInput>(non_empty(prefix), max_results,
+                                           non_empty(next_token));
+}
+
+// Inputs that consist of a queue URL only.
+template <typename Input>
+static std::optional<std::unique_ptr<Input>> read_queue_url_input(
+    std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value()) return {};
+
+  return std::make_unique<Input>(qurl.value());
+}
+
+std::optional<std::unique_ptr<DeleteQueueInput>>
+CborSerde::deserialize_delete_queue_input(std::string& str) {
+  return read_queue_url_input<DeleteQueueInput>(str);
+}
+
+std::optional<std::unique_ptr<TagQueueInput>>
+CborSerde::deserialize_tag_queue_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::map<std::string, std::string>> tags;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "Tags") {
+      tags = read_dict(r);
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value() || !tags.has_value()) return {};
+
+  return std::make_unique<TagQueueInput>(qurl.value(), tags.value());
+}
+
+std::optional<std::unique_ptr<ListQueueTagsInput>>
+CborSerde::deserialize_list_queue_tags_input(std::string& str) {
+  return read_queue_url_input<ListQueueTagsInput>(str);
+}
+
+std::optional<std::unique_ptr<UntagQueueInput>>
+CborSerde::deserialize_untag_queue_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::vector<std::string>> tag_keys;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "TagKeys") {
+      tag_keys = read_list(r);
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value() || !tag_keys.has_value()) return {};
+
+  return std::make_unique<UntagQueueInput>(qurl.value(), tag_keys.value());
+}
+
+std::optional<std::unique_ptr<SetQueueAttributesInput>>
+CborSerde::deserialize_set_queue_attributes_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::map<std::string, std::string>> attrs;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "Attributes") {
+      attrs = read_dict(r);
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value() || !attrs.has_value()) return {};
+
+  return std::make_unique<SetQueueAttributesInput>(qurl.value(),
+                                                   attrs.value());
+}
+
+std::optional<std::unique_ptr<GetQueueAttributesInput>>
+CborSerde::deserialize_get_queue_attributes_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::vector<std::string>> names;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "AttributeNames") {
+      names = read_list(r);
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value()) return {};
+
+  return std::make_unique<GetQueueAttributesInput>(qurl.value(), names);
+}
+
+std::optional<std::unique_ptr<SendMessageInput>>
+CborSerde::deserialize_send_message_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::string> body;
+  std::optional<long> delay;
+  std::optional<std::string> deduplication_id;
+  std::optional<std::string> group_id;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "MessageBody") {
+      body = r.read_string();
+    } else if (key == "DelaySeconds") {
+      delay = r.read_int();
+    } else if (key == "MessageDeduplicationId") {
+      deduplication_id = r.read_string();
+    } else if (key == "MessageGroupId") {
+      group_id = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  body = non_empty(std::move(body));
+  if (!r.at_end() || !qurl.has_value() || !body.has_value()) return {};
+
+  return std::make_unique<SendMessageInput>(
+      qurl.value(), std::move(body.value()), delay,
+      non_empty(deduplication_id), non_empty(group_id));
+}
+
+std::optional<std::unique_ptr<PurgeQueueInput>>
+CborSerde::deserialize_purge_queue_input(std::string& str) {
+  return read_queue_url_input<PurgeQueueInput>(str);
+}
+
+std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+CborSerde::deserialize_list_dead_letter_source_queues_input(std::string& str) {
+  return read_queue_url_input<ListDeadLetterSourceQueuesInput>(str);
+}
+
+std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+CborSerde::deserialize_start_message_move_task_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> source_arn;
+  std::optional<std::string> destination_arn;
+  std::optional<long> max_per_second;
+  r.read_map([&](std::string_view key) {
+    if (key == "SourceArn") {
+      source_arn = r.read_string();
+    } else if (key == "DestinationArn") {
+      destination_arn = r.read_string();
+    } else if (key == "MaxNumberOfMessagesPerSecond") {
+      max_per_second = r.read_int();
+    } else {
+      r.skip();
+    }
+  });
+  source_arn = non_empty(source_arn);
+  if (!r.at_end() || !source_arn.has_value()) return {};
+
+  return std::make_unique<StartMessageMoveTaskInput>(
+      source_arn.value(), non_empty(destination_arn), max_per_second);
+}
+
+std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+CborSerde::deserialize_cancel_message_move_task_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> task_handle;
+  r.read_map([&](std::string_view key) {
+    if (key == "TaskHandle") {
+      task_handle = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  task_handle = non_empty(task_handle);
+  if (!r.at_end() || !task_handle.has_value()) return {};
+
+  return std::make_unique<CancelMessageMoveTaskInput>(task_handle.value());
+}
+
+std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+CborSerde::deserialize_list_message_move_tasks_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> source_arn;
+  std::optional<int> max_results;
+  r.read_map([&](std::string_view key) {
+    if (key == "SourceArn") {
+      source_arn = r.read_string();
+    } else if (key == "MaxResults") {
+      max_results = read_int_param(r);
+    } else {
+      r.skip();
+    }
+  });
+  source_arn = non_empty(source_arn);
+  if (!r.at_end() || !source_arn.has_value()) return {};
+
+  return std::make_unique<ListMessageMoveTasksInput>(source_arn.value(),
+                                                     max_results);
+}
+
+std::optional<std::unique_ptr<ReceiveMessageInput>>
+CborSerde::deserialize_receive_message_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<int> max_number_of_messages;
+  std::optional<std::string> attempt_id;
+  std::optional<int> visibility_timeout;
+  std::optional<long> wait_time;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "MaxNumberOfMessages") {
+      max_number_of_messages = read_int_param(r);
+    } else if (key == "ReceiveRequestAttemptId") {
+      attempt_id = r.read_string();
+    } else if (key == "VisibilityTimeout") {
+      visibility_timeout = read_int_param(r);
+    } else if (key == "WaitTimeSeconds") {
+      wait_time = r.read_int();
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !qurl.has_value()) return {};
+
+  return std::make_unique<ReceiveMessageInput>(
+      qurl.value(), max_number_of_messages, non_empty(attempt_id),
+      visibility_timeout, wait_time);
+}
+
+std::optional<std::unique_ptr<DeleteMessageInput>>
+CborSerde::deserialize_delete_message_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::string> receipt_handle;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "ReceiptHandle") {
+      receipt_handle = r.read_string();
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  receipt_handle = non_empty(receipt_handle);
+  if (!r.at_end() || !qurl.has_value() || !receipt_handle.has_value()) {
+    return {};
+  }
+
+  return std::make_unique<DeleteMessageInput>(qurl.value(),
+                                              receipt_handle.value());
+}
+
+std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+CborSerde::deserialize_change_message_visibility_input(std::string& str) {
+  CborReader r(str);
+  std::optional<std::string> qurl;
+  std::optional<std::string> receipt_handle;
+  std::optional<long> visibility_timeout;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "ReceiptHandle") {
+      receipt_handle = r.read_string();
+    } else if (key == "VisibilityTimeout") {
+      visibility_timeout = r.read_int();
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  receipt_handle = non_empty(receipt_handle);
+  if (!r.at_end() || !qurl.has_value() || !receipt_handle.has_value() ||
+      !visibility_timeout.has_value()) {
+    return {};
+  }
+
+  return std::make_unique<ChangeMessageVisibilityInput>(
+      qurl.value(), receipt_handle.value(), visibility_timeout.value());
+}
+
+// Reads the QueueUrl and the Entries of a batch input, each entry's members
+// through `read_member`. `finish_entry` is called after each entry and
+// returns whether it holds all required members.
+template <typename ReadMember, typename FinishEntry>
+static std::optional<std::string> read_batch(CborReader& r,
+                                             ReadMember read_member,
+                                             FinishEntry finish_entry) {
+  std::optional<std::string> qurl;
+  bool has_entries = false;
+  bool entries_complete = true;
+  r.read_map([&](std::string_view key) {
+    if (key == "QueueUrl") {
+      qurl = r.read_string();
+    } else if (key == "Entries") {
+      has_entries = r.read_array([&]() {
+        r.read_map([&](std::string_view key) { read_member(key); });
+        entries_complete = entries_complete && r.ok() && finish_entry();
+      });
+    } else {
+      r.skip();
+    }
+  });
+  qurl = non_empty(qurl);
+  if (!r.at_end() || !has_entries || !entries_complete) return {};
+  return qurl;
+}
+
+std::optional<std::unique_ptr<SendMessageBatchInput>>
+CborSerde::deserialize_send_message_batch_input(std::string& str) {
+  CborReader r(str);
+  std::vector<SendMessageBatchEntry> entries;
+  SendMessageBatchEntry entry;
+  auto qurl = read_batch(
+      r,
+      [&](std::string_view key) {
+        if (key == "Id") {
+          entry.id = r.read_string().value_or("");
+        } else if (key == "MessageBody") {
+          entry.message_body = r.read_string().value_or("");
+        } else if (key == "DelaySeconds") {
+          entry.delay_seconds = r.read_int();
+        } else if (key == "MessageDeduplicationId") {
+          entry.message_deduplication_id = non_empty(r.read_string());
+        } else if (key == "MessageGroupId") {
+          entry.message_group_id = non_empty(r.read_string());
+        } else {
+          r.skip();
+        }
+      },
+      [&]() {
+        if (entry.id.empty() || entry.message_body.empty()) return false;
+        entries.push_back(std::move(entry));
+        entry = SendMessageBatchEntry();
+        return true;
+      });
+  if (!qurl.has_value()) return {};
+
+  return std::make_unique<SendMessageBatchInput>(qurl.value(),
+                                                 std::move(entries));
+}
+
+std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+CborSerde::deserialize_delete_message_batch_input(std::string& str) {
+  CborReader r(str);
+  std::vector<DeleteMessageBatchEntry> entries;
+  DeleteMessageBatchEntry entry;
+  auto qurl = read_batch(
+      r,
+      [&](std::string_view key) {
+        if (key == "Id") {
+          entry.id = r.read_string().value_or("");
+        } else if (key == "ReceiptHandle") {
+          entry.receipt_handle = r.read_string().value_or("");
+        } else {
+          r.skip();
+        }
+      },
+      [&]() {
+        if (entry.id.empty() || entry.receipt_handle.empty()) return false;
+        entries.push_back(std::move(entry));
+        entry = DeleteMessageBatchEntry();
+        return true;
+      });
+  if (!qurl.has_value()) return {};
+
+  return std::make_unique<DeleteMessageBatchInput>(qurl.value(),
+                                                   std::move(entries));
+}
+
+std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+CborSerde::deserialize_change_message_visibility_batch_input(
+    std::string& str) {
+  CborReader r(str);
+  std::vector<ChangeMessageVisibilityBatchEntry> entries;
+  ChangeMessageVisibilityBatchEntry entry;
+  std::optional<long> visibility_timeout;
+  auto qurl = read_batch(
+      r,
+      [&](std::string_view key) {
+        if (key == "Id") {
+          entry.id = r.read_string().value_or("");
+        } else if (key == "ReceiptHandle") {
+          entry.receipt_handle = r.read_string().value_or("");
+        } else if (key == "VisibilityTimeout") {
+          visibility_timeout = r.read_int();
+        } else {
+          r.skip();
+        }
+      },
+      [&]() {
+        if (entry.id.empty() || entry.receipt_handle.empty() ||
+            !visibility_timeout.has_value()) {
+          return false;
+        }
+        entry.visibility_timeout = visibility_timeout.value();
+        entries.push_back(std::move(entry));
+        entry = ChangeMessageVisibilityBatchEntry();
+        visibility_timeout.reset();
+        return true;
+      });
+  if (!qurl.has_value()) return {};
+
+  return std::make_unique<ChangeMessageVisibilityBatchInput>(
+      qurl.value(), std::move(entries));
+}
+
 std::string HtmlSerde::render_html(std::string& body) {
   std::stringstream ss;
   ss << "<!DOCTYPE html>";
@@ -301,7 +1527,7 @@ std::string HtmlSerde::serialize(CreateQueueResponse* res) {
 std::string HtmlSerde::serialize(ListQueuesResponse* res) {
   std::stringstream ss;
   ss << "<h1 class=\"title\">Queues</h1>";
-  if (res->queue_urls->empty()) {
+  if (res->queues.empty()) {
     ss << "<p>No queues found.</p>";
   } else {
     ss << "<table class=\"table is-fullwidth\">";
@@ -312,17 +1538,21 @@ std::string HtmlSerde::serialize(ListQueuesResponse* res) {
     ss << "</tr>";
     ss << "</thead>";
     ss << "<tbody>";
-    for (const auto& info : *(res->queue_urls)) {
+    for (const auto& info : res->queues) {
       ss << "<tr>";
       ss << "<td>";
       ss << "<a href=\"/queues/" << info.queue_name << "\">";
       ss << info.queue_url << "</a></td>";
-      ss << "<td>" << info.message_count << "</td>";
+      ss << "<td>" << info.message_count.value_or(0) << "</td>";
       ss << "</tr>";
     }
     ss << "</tbody>";
     ss << "</table>";
   }
+  if (res->pending_reclamation_bytes > 0) {
+    ss << "<p>" << res->pending_reclamation_bytes
+       << " bytes of purged messages are being freed.</p>";
+  }
   auto body = ss.str();
   return render_html(body);
 }
@@ -355,6 +1585,11 @@ std::string HtmlSerde::serialize(FullQueueDataResponse* res) {
   for (const auto& [key, value] : res->attributes) {
     ss << "<tr><td>" << key << "</td><td>" << value << "</td></tr>";
   }
+  ss << "<tr><td>Body Pool Reserved</td><td>"
+     << res->body_pool_stats.bytes_reserved << " bytes</td></tr>";
+  ss << "<tr><td>Body Pool In Use</td><td>"
+     << res->body_pool_stats.bytes_in_use << " bytes in "
+     << res->body_pool_stats.blocks_in_use << " blocks</td></tr>";
   if (!res->tags.empty()) {
     ss << "<tr><td>Tags</td><td>";
     for (const auto& [key, value] : res->tags) {
@@ -376,7 +1611,7 @@ std::string HtmlSerde::serialize(FullQueueDataResponse* res) {
   for (const auto& msg : res->messages) {
     ss << "<tr>";
     ss << "<td>" << msg.message_id << "</td>";
-    ss << "<td><pre>" << msg.body << "</pre></td>";
+    ss << "<td><pre>" << msg.body.view() << "</pre></td>";
     ss << "</tr>";
   }
   ss << "</table>";
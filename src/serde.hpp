@@ -9,23 +9,41 @@
 using json = nlohmann::json;
 
 namespace sqscpp {
+// prefix of the shape ids naming errors
+const std::string SQS_SHAPE_NAMESPACE = "com.amazonaws.sqs#";
+
 class Serde {
  public:
   virtual std::string contentType() = 0;
+  // Reads the top level string member `member` of a request without
+  // decoding the rest of it, nothing when there is none. Shards route
+  // requests by it.
+  virtual std::optional<std::string> read_string_member(
+      std::string &str, std::string_view member) = 0;
   virtual std::string serialize(Error *err) = 0;
+  virtual std::string serialize(EmptyResponse *res) = 0;
   virtual std::string serialize(CreateQueueResponse *res) = 0;
   virtual std::string serialize(ListQueuesResponse *res) = 0;
   virtual std::string serialize(GetQueueUrlResponse *res) = 0;
   virtual std::string serialize(ListQueueTagsResponse *res) = 0;
+  virtual std::string serialize(GetQueueAttributesResponse *res) = 0;
   virtual std::string serialize(ReceivedMessageResponse *res) = 0;
   virtual std::string serialize(ReceivedMessagesResponse *res) = 0;
   virtual std::string serialize(SendMessageResponse *res) = 0;
+  virtual std::string serialize(SendMessageBatchResponse *res) = 0;
+  virtual std::string serialize(BatchResponse *res) = 0;
+  virtual std::string serialize(ListDeadLetterSourceQueuesResponse *res) = 0;
+  virtual std::string serialize(StartMessageMoveTaskResponse *res) = 0;
+  virtual std::string serialize(CancelMessageMoveTaskResponse *res) = 0;
+  virtual std::string serialize(ListMessageMoveTasksResponse *res) = 0;
   virtual std::string serialize(FullQueueDataResponse *res) = 0;
 
   virtual std::optional<std::unique_ptr<CreateQueueInput>>
   deserialize_create_queue_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<GetQueueUrlInput>>
   deserialize_get_queue_url_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<ListQueuesInput>>
+  deserialize_list_queues_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<DeleteQueueInput>>
   deserialize_delete_queue_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<TagQueueInput>>
@@ -34,6 +52,10 @@ class Serde {
   deserialize_list_queue_tags_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<UntagQueueInput>>
   deserialize_untag_queue_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<SetQueueAttributesInput>>
+  deserialize_set_queue_attributes_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<GetQueueAttributesInput>>
+  deserialize_get_queue_attributes_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<SendMessageInput>>
   deserialize_send_message_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<PurgeQueueInput>>
@@ -42,6 +64,22 @@ class Serde {
   deserialize_receive_message_input(std::string &str) = 0;
   virtual std::optional<std::unique_ptr<DeleteMessageInput>>
   deserialize_delete_message_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+  deserialize_change_message_visibility_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<SendMessageBatchInput>>
+  deserialize_send_message_batch_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+  deserialize_delete_message_batch_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+  deserialize_change_message_visibility_batch_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+  deserialize_list_dead_letter_source_queues_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+  deserialize_start_message_move_task_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+  deserialize_cancel_message_move_task_input(std::string &str) = 0;
+  virtual std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+  deserialize_list_message_move_tasks_input(std::string &str) = 0;
 };
 
 class JsonSerde : public Serde {
@@ -53,15 +91,98 @@ class JsonSerde : public Serde {
   std::optional<int> parse_int(json j);
 
   std::string contentType() override { return "application/json"; }
+  std::optional<std::string> read_string_member(
+      std::string &str, std::string_view member) override;
+
+  std::string serialize(Error *err) override;
+  std::string serialize(EmptyResponse *res) override { return "{}"; }
+  std::string serialize(CreateQueueResponse *res) override;
+  std::string serialize(ListQueuesResponse *res) override;
+  std::string serialize(GetQueueUrlResponse *res) override;
+  std::string serialize(ListQueueTagsResponse *res) override;
+  std::string serialize(GetQueueAttributesResponse *res) override;
+  std::string serialize(ReceivedMessageResponse *res) override;
+  std::string serialize(ReceivedMessagesResponse *res) override;
+  std::string serialize(SendMessageResponse *res) override;
+  std::string serialize(SendMessageBatchResponse *res) override;
+  std::string serialize(BatchResponse *res) override;
+  std::string serialize(ListDeadLetterSourceQueuesResponse *res) override;
+  std::string serialize(StartMessageMoveTaskResponse *res) override;
+  std::string serialize(CancelMessageMoveTaskResponse *res) override;
+  std::string serialize(ListMessageMoveTasksResponse *res) override;
+  std::string serialize(FullQueueDataResponse *res) override {
+    throw std::runtime_error("not implemented");
+  }
+
+  std::optional<std::unique_ptr<CreateQueueInput>>
+  deserialize_create_queue_input(std::string &str) override;
+  std::optional<std::unique_ptr<GetQueueUrlInput>>
+  deserialize_get_queue_url_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListQueuesInput>> deserialize_list_queues_input(
+      std::string &str) override;
+  std::optional<std::unique_ptr<DeleteQueueInput>>
+  deserialize_delete_queue_input(std::string &str) override;
+  std::optional<std::unique_ptr<TagQueueInput>> deserialize_tag_queue_input(
+      std::string &str) override;
+  std::optional<std::unique_ptr<ListQueueTagsInput>>
+  deserialize_list_queue_tags_input(std::string &str) override;
+  std::optional<std::unique_ptr<UntagQueueInput>> deserialize_untag_queue_input(
+      std::string &str) override;
+  std::optional<std::unique_ptr<SetQueueAttributesInput>>
+  deserialize_set_queue_attributes_input(std::string &str) override;
+  std::optional<std::unique_ptr<GetQueueAttributesInput>>
+  deserialize_get_queue_attributes_input(std::string &str) override;
+  std::optional<std::unique_ptr<SendMessageInput>>
+  deserialize_send_message_input(std::string &str) override;
+  std::optional<std::unique_ptr<PurgeQueueInput>> deserialize_purge_queue_input(
+      std::string &str) override;
+  std::optional<std::unique_ptr<ReceiveMessageInput>>
+  deserialize_receive_message_input(std::string &str) override;
+  std::optional<std::unique_ptr<DeleteMessageInput>>
+  deserialize_delete_message_input(std::string &str) override;
+  std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+  deserialize_change_message_visibility_input(std::string &str) override;
+  std::optional<std::unique_ptr<SendMessageBatchInput>>
+  deserialize_send_message_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+  deserialize_delete_message_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+  deserialize_change_message_visibility_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+  deserialize_list_dead_letter_source_queues_input(std::string &str) override;
+  std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+  deserialize_start_message_move_task_input(std::string &str) override;
+  std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+  deserialize_cancel_message_move_task_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+  deserialize_list_message_move_tasks_input(std::string &str) override;
+};
+
+// Smithy RPC v2 CBOR, spoken by newer AWS SDKs. Inputs are decoded straight
+// from the request body and responses encoded straight into a buffer, with
+// no document in between.
+class CborSerde : public Serde {
+ public:
+  std::string contentType() override { return "application/cbor"; }
+  std::optional<std::string> read_string_member(
+      std::string &str, std::string_view member) override;
 
   std::string serialize(Error *err) override;
+  std::string serialize(EmptyResponse *res) override;
   std::string serialize(CreateQueueResponse *res) override;
   std::string serialize(ListQueuesResponse *res) override;
   std::string serialize(GetQueueUrlResponse *res) override;
   std::string serialize(ListQueueTagsResponse *res) override;
+  std::string serialize(GetQueueAttributesResponse *res) override;
   std::string serialize(ReceivedMessageResponse *res) override;
   std::string serialize(ReceivedMessagesResponse *res) override;
   std::string serialize(SendMessageResponse *res) override;
+  std::string serialize(SendMessageBatchResponse *res) override;
+  std::string serialize(BatchResponse *res) override;
+  std::string serialize(ListDeadLetterSourceQueuesResponse *res) override;
+  std::string serialize(StartMessageMoveTaskResponse *res) override;
+  std::string serialize(CancelMessageMoveTaskResponse *res) override;
+  std::string serialize(ListMessageMoveTasksResponse *res) override;
   std::string serialize(FullQueueDataResponse *res) override {
     throw std::runtime_error("not implemented");
   }
@@ -70,6 +191,8 @@ class JsonSerde : public Serde {
   deserialize_create_queue_input(std::string &str) override;
   std::optional<std::unique_ptr<GetQueueUrlInput>>
   deserialize_get_queue_url_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListQueuesInput>> deserialize_list_queues_input(
+      std::string &str) override;
   std::optional<std::unique_ptr<DeleteQueueInput>>
   deserialize_delete_queue_input(std::string &str) override;
   std::optional<std::unique_ptr<TagQueueInput>> deserialize_tag_queue_input(
@@ -78,6 +201,10 @@ class JsonSerde : public Serde {
   deserialize_list_queue_tags_input(std::string &str) override;
   std::optional<std::unique_ptr<UntagQueueInput>> deserialize_untag_queue_input(
       std::string &str) override;
+  std::optional<std::unique_ptr<SetQueueAttributesInput>>
+  deserialize_set_queue_attributes_input(std::string &str) override;
+  std::optional<std::unique_ptr<GetQueueAttributesInput>>
+  deserialize_get_queue_attributes_input(std::string &str) override;
   std::optional<std::unique_ptr<SendMessageInput>>
   deserialize_send_message_input(std::string &str) override;
   std::optional<std::unique_ptr<PurgeQueueInput>> deserialize_purge_queue_input(
@@ -86,6 +213,22 @@ class JsonSerde : public Serde {
   deserialize_receive_message_input(std::string &str) override;
   std::optional<std::unique_ptr<DeleteMessageInput>>
   deserialize_delete_message_input(std::string &str) override;
+  std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+  deserialize_change_message_visibility_input(std::string &str) override;
+  std::optional<std::unique_ptr<SendMessageBatchInput>>
+  deserialize_send_message_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+  deserialize_delete_message_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+  deserialize_change_message_visibility_batch_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+  deserialize_list_dead_letter_source_queues_input(std::string &str) override;
+  std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+  deserialize_start_message_move_task_input(std::string &str) override;
+  std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+  deserialize_cancel_message_move_task_input(std::string &str) override;
+  std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+  deserialize_list_message_move_tasks_input(std::string &str) override;
 };
 
 class HtmlSerde : public Serde {
@@ -94,16 +237,45 @@ class HtmlSerde : public Serde {
 
  public:
   std::string contentType() override { return "text/html"; }
+  // html requests name their queue in the path
+  std::optional<std::string> read_string_member(
+      std::string &str, std::string_view member) override {
+    return {};
+  }
 
   std::string serialize(Error *err) override;
+  std::string serialize(EmptyResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
   std::string serialize(CreateQueueResponse *res) override;
   std::string serialize(ListQueuesResponse *res) override;
   std::string serialize(GetQueueUrlResponse *res) override;
   std::string serialize(ListQueueTagsResponse *res) override;
+  std::string serialize(GetQueueAttributesResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
   std::string serialize(ReceivedMessageResponse *res) override;
   std::string serialize(SendMessageResponse *res) override {
     throw std::runtime_error("not implemented");
   };
+  std::string serialize(SendMessageBatchResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::string serialize(BatchResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::string serialize(ListDeadLetterSourceQueuesResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::string serialize(StartMessageMoveTaskResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::string serialize(CancelMessageMoveTaskResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::string serialize(ListMessageMoveTasksResponse *res) override {
+    throw std::runtime_error("not implemented");
+  };
   std::string serialize(ReceivedMessagesResponse *res) override {
     throw std::runtime_error("not implemented");
   };
@@ -117,6 +289,12 @@ class HtmlSerde : public Serde {
   deserialize_get_queue_url_input(std::string &str) override {
     throw std::runtime_error("not implemented");
   }
+  // the queues page shows message counts and is not paginated
+  std::optional<std::unique_ptr<ListQueuesInput>> deserialize_list_queues_input(
+      std::string &str) override {
+    return std::make_unique<ListQueuesInput>(std::nullopt, std::nullopt,
+                                             std::nullopt, true);
+  }
   std::optional<std::unique_ptr<DeleteQueueInput>>
   deserialize_delete_queue_input(std::string &str) override {
     throw std::runtime_error("not implemented");
@@ -133,6 +311,14 @@ class HtmlSerde : public Serde {
       std::string &str) override {
     throw std::runtime_error("not implemented");
   }
+  std::optional<std::unique_ptr<SetQueueAttributesInput>>
+  deserialize_set_queue_attributes_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  }
+  std::optional<std::unique_ptr<GetQueueAttributesInput>>
+  deserialize_get_queue_attributes_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  }
   std::optional<std::unique_ptr<SendMessageInput>>
   deserialize_send_message_input(std::string &str) override {
     throw std::runtime_error("not implemented");
@@ -149,6 +335,40 @@ class HtmlSerde : public Serde {
   deserialize_delete_message_input(std::string &str) override {
     throw std::runtime_error("not implemented");
   };
+  std::optional<std::unique_ptr<ChangeMessageVisibilityInput>>
+  deserialize_change_message_visibility_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<SendMessageBatchInput>>
+  deserialize_send_message_batch_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<DeleteMessageBatchInput>>
+  deserialize_delete_message_batch_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<ChangeMessageVisibilityBatchInput>>
+  deserialize_change_message_visibility_batch_input(
+      std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<ListDeadLetterSourceQueuesInput>>
+  deserialize_list_dead_letter_source_queues_input(
+      std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<StartMessageMoveTaskInput>>
+  deserialize_start_message_move_task_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<CancelMessageMoveTaskInput>>
+  deserialize_cancel_message_move_task_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
+  std::optional<std::unique_ptr<ListMessageMoveTasksInput>>
+  deserialize_list_message_move_tasks_input(std::string &str) override {
+    throw std::runtime_error("not implemented");
+  };
 };
 }  // namespace sqscpp
 
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "serde.hpp"
+
+using namespace sqscpp;
+
+const int ITERATIONS = 200000;
+const std::string BODY(256, 'x');
+const std::string QUEUE_URL = "http://localhost:8080/000000000000/bench";
+const std::string RECEIPT_HANDLE = "0b7e2f0c-43a4-4c1a-9a6e-5d0c1e7a9f21";
+
+// Nanoseconds per call of `fn`.
+double time_per_op(const std::function<void()>& fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    fn();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         ITERATIONS;
+}
+
+std::string as_cbor(const json& j) {
+  auto bytes = json::to_cbor(j);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+// Times decoding `input` and the encoded input size for each serde.
+void bench_decode(const std::string& name, const json& input,
+                  const std::function<void(Serde&, std::string&)>& decode) {
+  JsonSerde json_serde;
+  CborSerde cbor_serde;
+  auto json_input = input.dump();
+  auto cbor_input = as_cbor(input);
+  auto json_ns = time_per_op([&]() { decode(json_serde, json_input); });
+  auto cbor_ns = time_per_op([&]() { decode(cbor_serde, cbor_input); });
+  std::cout << name << "\t" << (long)json_ns << "\t" << json_input.size()
+            << "\t" << (long)cbor_ns << "\t" << cbor_input.size()
+            << std::endl;
+}
+
+// Times encoding with `encode` and the size of the result for each serde.
+void bench_encode(const std::string& name,
+                  const std::function<std::string(Serde&)>& encode) {
+  JsonSerde json_serde;
+  CborSerde cbor_serde;
+  auto json_size = encode(json_serde).size();
+  auto cbor_size = encode(cbor_serde).size();
+  auto json_ns = time_per_op([&]() { encode(json_serde); });
+  auto cbor_ns = time_per_op([&]() { encode(cbor_serde); });
+  std::cout << name << "\t" << (long)json_ns << "\t" << json_size << "\t"
+            << (long)cbor_ns << "\t" << cbor_size << std::endl;
+}
+
+auto main() -> int {
+  std::cout << "operation\t\tjson ns\tbytes\tcbor ns\tbytes" << std::endl;
+
+  bench_decode("SendMessage\t",
+               {{"QueueUrl", QUEUE_URL}, {"MessageBody", BODY}},
+               [](Serde& serde, std::string& str) {
+                 serde.deserialize_send_message_input(str);
+               });
+
+  json entries = json::array();
+  for (int i = 0; i < 10; i++) {
+    entries.push_back(
+        {{"Id", "m" + std::to_string(i)}, {"ReceiptHandle", RECEIPT_HANDLE}});
+  }
+  bench_decode("DeleteMessageBatch",
+               {{"QueueUrl", QUEUE_URL}, {"Entries", entries}},
+               [](Serde& serde, std::string& str) {
+                 serde.deserialize_delete_message_batch_input(str);
+               });
+
+  ReceivedMessagesResponse received;
+  for (int i = 0; i < 10; i++) {
+    received.messages.push_back(ReceivedMessageResponse{
+        RECEIPT_HANDLE, RECEIPT_HANDLE, "5d41402abc4b2a76b9719d911017c592",
+        Body(BODY), 1});
+  }
+  bench_encode("ReceiveMessage\t", [&received](Serde& serde) {
+    return serde.serialize(&received);
+  });
+
+  BatchResponse batch;
+  for (int i = 0; i < 10; i++) {
+    batch.successful.push_back("m" + std::to_string(i));
+  }
+  bench_encode("DeleteMessageBatch",
+               [&batch](Serde& serde) { return serde.serialize(&batch); });
+  return 0;
+}
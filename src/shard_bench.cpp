@@ -0,0 +1,126 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mailbox.hpp"
+#include "serde.hpp"
+#include "sqs.hpp"
+
+using namespace sqscpp;
+
+const int REQUESTS_PER_THREAD = 60000;
+const int QUEUES = 64;
+const std::string ENDPOINT = "http://localhost:8080/000000000000";
+const std::string BODY(256, 'x');
+
+// Sends, receives and deletes a message on `qurl` through the JSON serde
+// like the router does, three requests in all.
+static void round_trip(SQS* sqs, JsonSerde* serde, const std::string& qurl) {
+  json send_req = {{"QueueUrl", qurl}, {"MessageBody", BODY}};
+  auto str = send_req.dump();
+  auto send = serde->deserialize_send_message_input(str).value();
+  auto sent = sqs->send_message(send.get()).second;
+  serde->serialize(sent.get());
+
+  json receive_req = {{"QueueUrl", qurl}, {"MaxNumberOfMessages", 1}};
+  str = receive_req.dump();
+  auto receive = serde->deserialize_receive_message_input(str).value();
+  for (auto& msg : sqs->receive(receive.get())) {
+    json delete_req = {{"QueueUrl", qurl},
+                       {"ReceiptHandle", format_uuid(msg.receipt_handle)}};
+    str = delete_req.dump();
+    auto del = serde->deserialize_delete_message_input(str).value();
+    sqs->delete_message(del.get());
+  }
+}
+
+// Requests per second handled by `threads` reactor threads spreading their
+// requests over QUEUES queues, the network left out. Shared, every thread
+// handles every request on one SQS. Sharded, every thread owns the queues
+// shard_of assigns it on an SQS of its own and posts the requests for the
+// others' queues to their mailbox, as a server started with --shards does.
+// `forwarded` is set to the share of requests that were posted.
+double throughput(int threads, bool sharded, double* forwarded) {
+  std::vector<std::unique_ptr<Mailbox>> mailboxes;
+  for (int t = 0; t < threads; t++) {
+    // the shards poll their mailbox between requests
+    mailboxes.push_back(std::make_unique<Mailbox>([]() {}));
+  }
+  std::vector<std::unique_ptr<SQS>> instances;
+  std::vector<Shard> shards;
+  for (int t = 0; t < (sharded ? threads : 1); t++) {
+    instances.push_back(std::make_unique<SQS>(ENDPOINT));
+    shards.push_back(Shard{instances.back().get(), mailboxes[t].get()});
+  }
+  if (sharded) {
+    for (int t = 0; t < threads; t++) {
+      instances[t]->join_shards(shards, t);
+    }
+  }
+
+  JsonSerde serde;
+  std::vector<std::string> qurls;
+  std::vector<int> owners;
+  for (int q = 0; q < QUEUES; q++) {
+    auto qname = "bench-" + std::to_string(q);
+    auto owner = sharded ? shard_of(qname, threads) : 0;
+    auto create = CreateQueueInput(qname, {});
+    qurls.push_back(instances[owner]->create_queue(&create).value());
+    owners.push_back(owner);
+  }
+
+  const long total = (long)threads * REQUESTS_PER_THREAD / 3;
+  std::atomic<long> done = 0;
+  std::atomic<long> posted = 0;
+  auto shard = [&](int t) {
+    for (int i = 0; i < REQUESTS_PER_THREAD / 3; i++) {
+      int q = (t * 7 + i) % QUEUES;
+      if (!sharded || owners[q] == t) {
+        round_trip(instances[sharded ? t : 0].get(), &serde, qurls[q]);
+        done++;
+      } else {
+        auto sqs = instances[owners[q]].get();
+        mailboxes[owners[q]]->post([&, sqs, q]() {
+          round_trip(sqs, &serde, qurls[q]);
+          done++;
+        });
+        posted++;
+      }
+      mailboxes[t]->drain();
+    }
+    while (done < total) {
+      if (mailboxes[t]->drain() == 0) {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back(shard, t);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  *forwarded = (double)posted / total;
+  return threads * REQUESTS_PER_THREAD /
+         std::chrono::duration<double>(elapsed).count();
+}
+
+auto main() -> int {
+  int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "shards\tshared req/s\tsharded req/s\tforwarded" << std::endl;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    double forwarded;
+    auto shared = throughput(threads, false, &forwarded);
+    auto sharded = throughput(threads, true, &forwarded);
+    std::cout << threads << "\t" << (long)shared << "\t\t" << (long)sharded
+              << "\t\t" << forwarded << std::endl;
+  }
+  return 0;
+}
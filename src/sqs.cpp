@@ -2,25 +2,251 @@
 
 #include <openssl/evp.h>
 
-#include <boost/lexical_cast.hpp>
-#include <boost/uuid/uuid_io.hpp>
-#include <cstdio>
+#include <algorithm>
+#include <cctype>
 #include <ctime>
+#include <functional>
+#include <iterator>
+#include <thread>
 
 namespace sqscpp {
+std::shared_ptr<QueueState> QueueDirectory::find_queue(
+    std::string_view qurl) const {
+  auto id = ids_by_url.find(qurl);
+  if (id == ids_by_url.end()) {
+    return nullptr;
+  }
+  return states[id->second];
+}
+
+std::shared_ptr<QueueState> QueueDirectory::find_queue_by_name(
+    std::string_view qname) const {
+  auto id = ids_by_name.find(qname);
+  if (id == ids_by_name.end()) {
+    return nullptr;
+  }
+  return states[id->second];
+}
+
+size_t shard_of(std::string_view qname, size_t shards) {
+  return std::hash<std::string_view>()(qname) % shards;
+}
+
+std::optional<size_t> move_task_shard(std::string_view task_handle,
+                                      size_t shards) {
+  auto handle = parse_uuid(std::string(task_handle));
+  if (!handle.has_value() || handle->data[0] >= shards) {
+    return {};
+  }
+  return handle->data[0];
+}
+
 SQS::SQS(std::string ep) {
   endpoint = ep;
-  queues = std::map<std::string, std::deque<Message>>();
-  queue_attrs = std::map<std::string, std::map<std::string, std::string>>();
+  directory = std::make_shared<const QueueDirectory>();
+  scheduler.schedule(Clock::now() + REAP_INTERVAL, [this]() { reap(); });
+}
+
+void SQS::join_shards(std::vector<Shard> all, size_t index) {
+  shards = std::move(all);
+  shard = index;
+}
+
+void SQS::replicate(std::function<void(SQS&)> update) {
+  for (size_t i = 0; i < shards.size(); i++) {
+    if (i != shard) {
+      shards[i].mailbox->post(
+          [peer = shards[i].sqs, update]() { update(*peer); });
+    }
+  }
+}
+
+std::optional<SQS::NamedQueue> SQS::find_queue_by_name(
+    std::string_view qname) {
+  auto owner = shards.empty() ? shard : shard_of(qname, shards.size());
+  if (owner == shard) {
+    auto queue = directory.load()->find_queue_by_name(qname);
+    if (queue == nullptr) {
+      return {};
+    }
+    return NamedQueue{queue->name, queue->url, queue->fifo, shard, queue};
+  }
+  std::lock_guard lock(peers_mtx);
+  auto peer = peer_queues.find(qname);
+  if (peer == peer_queues.end()) {
+    return {};
+  }
+  return NamedQueue{peer->first, peer->second.url, peer->second.fifo, owner,
+                    nullptr};
+}
+
+// Publishes the message counts of a queue whose lock is held.
+static void publish_counters(QueueState& queue) {
+  auto& messages = queue.messages;
+  auto in_flight = messages.in_flight_size();
+  auto delayed = messages.delayed_size();
+  queue.counters.visible = messages.size() - in_flight - delayed;
+  queue.counters.not_visible = in_flight;
+  queue.counters.delayed = delayed;
+  queue.counters.waiters = queue.waiters.size();
+
+  auto oldest = messages.oldest_sent_at();
+  queue.counters.oldest_sent_at = oldest.value_or(0);
+  auto reap_at = std::numeric_limits<long>::max();
+  if (oldest.has_value()) {
+    reap_at = oldest.value() + queue.config.message_retention_period;
+  }
+  auto visible_at = messages.next_visible_at();
+  if (visible_at.has_value()) {
+    reap_at = std::min(reap_at, visible_at.value());
+  }
+  queue.counters.reap_at = reap_at;
+}
+
+// Runs `fn` on the QueueStates holding the messages of `queue`, which are
+// its partitions when it is striped and the queue itself otherwise.
+template <typename Fn>
+static void for_each_partition(const std::shared_ptr<QueueState>& queue,
+                               Fn fn) {
+  if (queue->partitions.empty()) {
+    fn(queue);
+  }
+  for (const auto& partition : queue->partitions) {
+    fn(partition);
+  }
+}
+
+// Index of the partition a thread turns to next. Every thread cycles from a
+// start of its own, so that threads spread out without sharing a counter.
+static size_t next_partition(size_t partitions) {
+  thread_local size_t next =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return next++ % partitions;
+}
+
+// Partition to send to, one with parked receives if there is any. The
+// waiters are counted without the partition lock, so a receive parking
+// meanwhile may be missed.
+static std::shared_ptr<QueueState> send_partition(
+    const std::shared_ptr<QueueState>& queue) {
+  auto& partitions = queue->partitions;
+  if (partitions.empty()) {
+    return queue;
+  }
+  auto start = next_partition(partitions.size());
+  for (size_t i = 0; i < partitions.size(); i++) {
+    auto& partition = partitions[(start + i) % partitions.size()];
+    if (partition->counters.waiters > 0) {
+      return partition;
+    }
+  }
+  return partitions[start];
 }
 
-std::string SQS::create_queue(CreateQueueInput* input) {
-  mtx.lock();
+// The partition that issued `receipt_handle`, null when there is none.
+static std::shared_ptr<QueueState> receipt_partition(
+    const std::shared_ptr<QueueState>& queue,
+    const boost::uuids::uuid& receipt_handle) {
+  if (queue->partitions.empty()) {
+    return queue;
+  }
+  auto idx = receipt_handle.data[0];
+  return idx < queue->partitions.size() ? queue->partitions[idx] : nullptr;
+}
+
+// Counters of a queue summed over its partitions.
+struct MessageCounts {
+  size_t visible = 0;
+  size_t not_visible = 0;
+  size_t delayed = 0;
+  long oldest_sent_at = 0;
+};
+
+static MessageCounts load_counts(const std::shared_ptr<QueueState>& queue) {
+  MessageCounts counts;
+  for_each_partition(queue, [&counts](const auto& partition) {
+    auto& counters = partition->counters;
+    counts.visible += counters.visible;
+    counts.not_visible += counters.not_visible;
+    counts.delayed += counters.delayed;
+    long oldest = counters.oldest_sent_at;
+    if (oldest != 0 &&
+        (counts.oldest_sent_at == 0 || oldest < counts.oldest_sent_at)) {
+      counts.oldest_sent_at = oldest;
+    }
+  });
+  return counts;
+}
+
+// FIFO queues are named *.fifo, and only they deduplicate by content. Only
+// standard queues are striped.
+static bool fits_queue_type(const QueueConfig& config,
+                            const std::string& qname) {
+  auto fifo_name = qname.ends_with(".fifo");
+  return config.fifo_queue == fifo_name &&
+         (config.fifo_queue ? config.partitions == 1
+                            : !config.content_based_deduplication);
+}
+
+std::optional<std::string> SQS::create_queue(CreateQueueInput* input) {
+  auto config = QueueConfig().with_attributes(input->get_attrs());
+  if (!config.has_value() ||
+      !fits_queue_type(config.value(), input->get_queue_name()) ||
+      !valid_redrive_policy(config.value(), input->get_queue_name())) {
+    return {};
+  }
+
   std::string qurl = new_queue_url(input->get_queue_name());
-  std::map<std::string, std::string> attrs = input->get_attrs();
-  queues[qurl] = std::deque<Message>();
-  queue_attrs[qurl] = attrs;
-  mtx.unlock();
+  std::lock_guard lock(directory_mtx);
+  auto current = directory.load();
+  if (current->ids_by_url.contains(qurl)) {
+    return qurl;
+  }
+
+  auto next = std::make_shared<QueueDirectory>(*current);
+  QueueId id = next->states.size();
+  if (next->free_ids.empty()) {
+    next->states.emplace_back();
+  } else {
+    id = next->free_ids.back();
+    next->free_ids.pop_back();
+  }
+
+  auto state = std::make_shared<QueueState>();
+  state->id = id;
+  state->name = input->get_queue_name();
+  state->url = qurl;
+  state->created_at = now();
+  state->fifo = config->fifo_queue;
+  state->body_pool = std::make_shared<BodyPool>();
+  state->config = std::move(config.value());
+  publish_attributes(*state, state->created_at);
+  // partitions allocate from pools of their own, their config follows the
+  // queue's
+  for (long i = 0; state->config.partitions > 1 && i < state->config.partitions;
+       i++) {
+    auto partition = std::make_shared<QueueState>();
+    partition->id = id;
+    partition->name = state->name;
+    partition->url = qurl;
+    partition->created_at = state->created_at;
+    partition->fifo = false;
+    partition->body_pool = std::make_shared<BodyPool>();
+    partition->config = state->config;
+    partition->messages.tag_receipts(i);
+    state->partitions.push_back(std::move(partition));
+  }
+  index_dead_letter_source(state->name, {}, state->config.redrive_policy);
+  replicate([name = state->name, peer = PeerQueue{qurl, state->fifo, state}](
+                SQS& sqs) {
+    std::lock_guard lock(sqs.peers_mtx);
+    sqs.peer_queues[name] = peer;
+  });
+
+  next->ids_by_url[qurl] = id;
+  next->ids_by_name[state->name] = id;
+  next->states[id] = std::move(state);
+  directory = std::move(next);
   return qurl;
 }
 
@@ -30,212 +256,1314 @@ std::string SQS::new_queue_url(std::string qname) {
   return ss.str();
 }
 
-std::string SQS::get_queue_name(std::string& qurl) {
-  auto pos = qurl.find_last_of('/');
-  return qurl.substr(pos + 1);
-}
-
-std::unique_ptr<std::vector<std::string>> SQS::get_queue_urls() {
-  std::vector<std::string> urls;
+std::pair<ListQueuesStatus, std::unique_ptr<ListQueuesResponse>>
+SQS::list_queues(ListQueuesInput* input) {
+  auto& max_results = input->get_max_results();
+  auto limit = max_results.value_or(MAX_LIST_QUEUES_RESULTS);
+  if (limit < 1 || limit > MAX_LIST_QUEUES_RESULTS) {
+    return {MaxResultsInvalid, nullptr};
+  }
 
-  for (const auto q : queues) {
-    urls.push_back(q.first);
+  // names sharing the prefix are contiguous in the ordered directory and
+  // replica of other shards' queues, the page starts after the cursor when it
+  // lies within them and takes at most one queue past the limit from each
+  auto prefix = input->get_queue_name_prefix().value_or("");
+  auto& next_token = input->get_next_token();
+  auto collect = [&](const auto& names, auto add) {
+    auto it = next_token.has_value() && next_token.value() >= prefix
+                  ? names.upper_bound(next_token.value())
+                  : names.lower_bound(prefix);
+    for (int n = 0; n <= limit && it != names.end() &&
+                    it->first.starts_with(prefix);
+         n++, it++) {
+      add(*it);
+    }
+  };
+  std::vector<std::pair<QueueInfo, std::shared_ptr<QueueState>>> found;
+  auto current = directory.load();
+  collect(current->ids_by_name, [&](const auto& entry) {
+    auto& queue = current->states[entry.second];
+    found.emplace_back(QueueInfo{queue->url, queue->name}, queue);
+  });
+  if (!shards.empty()) {
+    std::lock_guard lock(peers_mtx);
+    collect(peer_queues, [&](const auto& entry) {
+      found.emplace_back(QueueInfo{entry.second.url, entry.first},
+                         entry.second.state);
+    });
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+      return a.first.queue_name < b.first.queue_name;
+    });
   }
 
-  return std::make_unique<std::vector<std::string>>(urls);
+  auto res = std::make_unique<ListQueuesResponse>();
+  for (auto& [queue, state] : found) {
+    if (res->queues.size() == (size_t)limit) {
+      // AWS only paginates when asked to
+      if (max_results.has_value()) {
+        res->next_token = res->queues.back().queue_name;
+      }
+      break;
+    }
+    auto& info = res->queues.emplace_back(std::move(queue));
+    if (input->get_message_counts()) {
+      auto counts = load_counts(state);
+      info.message_count =
+          counts.visible + counts.not_visible + counts.delayed;
+    }
+  }
+  res->pending_reclamation_bytes = reclaimer.pending_bytes();
+  return {QueuesListed, std::move(res)};
 }
 
-std::optional<std::string> SQS::get_queue_url(std::string qname) {
-  auto qurl = new_queue_url(qname);
-  if (queues.find(qurl) == queues.end()) {
+std::optional<std::string> SQS::get_queue_url(std::string_view qname) {
+  auto queue = directory.load()->find_queue_by_name(qname);
+  if (queue == nullptr) {
     return {};
   }
-  return qurl;
+  return queue->url;
 }
 
 bool SQS::delete_queue(std::string qurl) {
-  mtx.lock();
-  if (queues.find(qurl) == queues.end()) {
-    mtx.unlock();
+  std::lock_guard lock(directory_mtx);
+  auto current = directory.load();
+  auto queue = current->find_queue(qurl);
+  if (queue == nullptr) {
     return false;
   }
 
-  queues.erase(qurl);
-  mtx.unlock();
+  auto next = std::make_shared<QueueDirectory>(*current);
+  next->ids_by_url.erase(queue->url);
+  next->ids_by_name.erase(queue->name);
+  next->states[queue->id] = nullptr;
+  next->free_ids.push_back(queue->id);
+  directory = std::move(next);
+  replicate([name = queue->name](SQS& sqs) {
+    std::lock_guard lock(sqs.peers_mtx);
+    sqs.peer_queues.erase(name);
+  });
+
+  std::unique_lock queue_lock(queue->mtx);
+  index_dead_letter_source(queue->name, queue->config.redrive_policy, {});
+  queue_lock.unlock();
+  for_each_partition(queue, [this](const auto& partition) {
+    Completions done;
+    std::unique_lock partition_lock(partition->mtx);
+    auto detached = partition->messages.detach();
+    for (auto& waiter : partition->waiters) {
+      done.receives.emplace_back(std::move(waiter.callback),
+                                 std::vector<Message>());
+    }
+    partition->waiters.clear();
+    partition_lock.unlock();
+    reclaimer.retire(std::move(detached));
+    complete(done);
+  });
   return true;
 }
 
 bool SQS::tag_queue(std::string qurl,
                     std::map<std::string, std::string>* tags) {
-  mtx.lock();
-  if (queues.find(qurl) == queues.end()) {
-    mtx.unlock();
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
     return false;
   }
-  if (queue_tags.find(qurl) == queue_tags.end()) {
-    queue_tags[qurl] = std::map<std::string, std::string>();
-  }
+
+  std::lock_guard queue_lock(queue->mtx);
   for (const auto& tag : *tags) {
-    queue_tags[qurl][tag.first] = tag.second;
+    queue->tags[tag.first] = tag.second;
   }
-  mtx.unlock();
   return true;
 }
 
 std::optional<std::unique_ptr<std::map<std::string, std::string>>>
 SQS::get_queue_tags(std::string qurl) {
-  if (queues.find(qurl) == queues.end()) {
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
     return {};
   }
-  return std::make_unique<std::map<std::string, std::string>>(queue_tags[qurl]);
+
+  std::lock_guard queue_lock(queue->mtx);
+  return std::make_unique<std::map<std::string, std::string>>(queue->tags);
 }
 
 bool SQS::untag_queue(std::string qurl, std::vector<std::string>* tag_keys) {
-  mtx.lock();
-  if (queues.find(qurl) == queues.end()) {
-    mtx.unlock();
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
     return false;
   }
-  if (queue_tags.find(qurl) == queue_tags.end()) {
-    mtx.unlock();
-    return true;
-  }
+
+  std::lock_guard queue_lock(queue->mtx);
   for (const auto& key : *tag_keys) {
-    queue_tags[qurl].erase(key);
+    queue->tags.erase(key);
   }
-  mtx.unlock();
   return true;
 }
 
-std::unique_ptr<SendMessageResponse> SQS::send_message(SendMessageInput* msg) {
-  mtx.lock();
-  auto queue = queues.find(msg->get_queue_url());
-  if (queue == queues.end()) {
-    mtx.unlock();
-    return nullptr;
+SetQueueAttributesStatus SQS::set_queue_attributes(
+    SetQueueAttributesInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return AttributesQueueNotFound;
   }
 
+  std::lock_guard queue_lock(queue->mtx);
+  // a delete that got in first has already dropped the queue's policy from
+  // the index, it must not be indexed again
+  if (directory.load()->find_queue(input->get_queue_url()) != queue) {
+    return AttributesQueueNotFound;
+  }
+  auto config = queue->config.with_attributes(input->get_attrs());
+  // the queue type and partitions are fixed at creation
+  if (!config.has_value() || !fits_queue_type(config.value(), queue->name) ||
+      config->partitions != queue->config.partitions ||
+      !valid_redrive_policy(config.value(), queue->name)) {
+    return AttributeValueInvalid;
+  }
+  index_dead_letter_source(queue->name, queue->config.redrive_policy,
+                           config->redrive_policy);
+  queue->config = std::move(config.value());
+  publish_attributes(*queue, now());
+  // a new retention period moves the reaper's deadline
+  publish_counters(*queue);
+  for (const auto& partition : queue->partitions) {
+    std::lock_guard partition_lock(partition->mtx);
+    partition->config = queue->config;
+    publish_counters(*partition);
+  }
+  return AttributesSet;
+}
+
+std::optional<std::unique_ptr<std::map<std::string, std::string>>>
+SQS::get_queue_attributes(GetQueueAttributesInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return {};
+  }
+
+  auto attrs = *queue->attributes.load();
+  auto counts = load_counts(queue);
+  attrs["ApproximateNumberOfMessages"] = std::to_string(counts.visible);
+  attrs["ApproximateNumberOfMessagesNotVisible"] =
+      std::to_string(counts.not_visible);
+  attrs["ApproximateNumberOfMessagesDelayed"] = std::to_string(counts.delayed);
+  auto oldest = counts.oldest_sent_at;
+  auto age = oldest == 0 ? 0 : std::max(now() - oldest, 0L);
+  attrs["ApproximateAgeOfOldestMessage"] = std::to_string(age);
+
+  auto& names = input->get_attribute_names();
+  if (names.empty() ||
+      std::find(names.begin(), names.end(), "All") != names.end()) {
+    return std::make_unique<std::map<std::string, std::string>>(
+        std::move(attrs));
+  }
+
+  auto selected = std::make_unique<std::map<std::string, std::string>>();
+  for (const auto& name : names) {
+    auto attr = attrs.find(name);
+    if (attr != attrs.end()) {
+      selected->insert(*attr);
+    }
+  }
+  return selected;
+}
+
+std::pair<SendMessageStatus, std::unique_ptr<SendMessageResponse>>
+SQS::send_message(SendMessageInput* msg) {
+  auto queue = directory.load()->find_queue(msg->get_queue_url());
+  if (queue == nullptr) {
+    return {SendQueueNotFound, nullptr};
+  }
+  queue = send_partition(queue);
+
+  // the input is not used afterwards, its body becomes the stored one
+  auto m = new_message(*queue, std::move(msg->get_message_body()));
+  auto params =
+      send_params(*queue, m, msg->get_delay_seconds(),
+                  msg->get_message_group_id(),
+                  msg->get_message_deduplication_id());
+  DedupEntry sent{m.message_id, m.md5_of_body};
+
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  auto status = enqueue(*queue, std::move(m), params, sent);
+  if (status != MessageSent) {
+    return {status, nullptr};
+  }
+  serve_waiters(*queue, done);
+  schedule_wake(queue);
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+  return {MessageSent,
+          std::make_unique<SendMessageResponse>(
+              format_uuid(sent.message_id), format_digest(sent.md5_of_body))};
+}
+
+// Checks the parameters of a receive against the limits of AWS, before any
+// queue is locked.
+static ReceiveStatus check_receive(ReceiveMessageInput* input) {
+  auto count = input->get_max_number_of_messages();
+  if (count.has_value() &&
+      (count.value() < 1 || count.value() > MAX_RECEIVE_MESSAGES)) {
+    return MaxNumberOfMessagesInvalid;
+  }
+  auto wait_time = input->get_wait_time_seconds();
+  if (wait_time.has_value() &&
+      (wait_time.value() < 0 || wait_time.value() > MAX_WAIT_TIME_SECONDS)) {
+    return WaitTimeSecondsInvalid;
+  }
+  auto visibility_timeout = input->get_visibility_timeout();
+  if (visibility_timeout.has_value() &&
+      (visibility_timeout.value() < 0 ||
+       visibility_timeout.value() > MAX_VISIBILITY_TIMEOUT)) {
+    return ReceiveVisibilityTimeoutInvalid;
+  }
+  return MessagesReceived;
+}
+
+// Checks the entry ids of a batch request, which AWS does before running any
+// of its entries.
+template <typename Entry>
+static BatchStatus check_batch(const std::vector<Entry>& entries) {
+  if (entries.empty()) {
+    return BatchEmpty;
+  }
+  if (entries.size() > MAX_BATCH_ENTRIES) {
+    return BatchTooManyEntries;
+  }
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto& id = entries[i].id;
+    auto valid = id.size() <= 80 &&
+                 std::all_of(id.begin(), id.end(), [](unsigned char c) {
+                   return std::isalnum(c) || c == '-' || c == '_';
+                 });
+    if (!valid) {
+      return BatchEntryIdInvalid;
+    }
+    for (size_t j = 0; j < i; j++) {
+      if (entries[j].id == id) {
+        return BatchIdsNotDistinct;
+      }
+    }
+  }
+  return BatchExecuted;
+}
+
+static BatchResultErrorEntry invalid_receipt_handle(const std::string& id) {
+  return BatchResultErrorEntry{id, true, "ReceiptHandleIsInvalid",
+                               "The specified receipt handle isn't valid."};
+}
+
+std::pair<BatchStatus, std::unique_ptr<SendMessageBatchResponse>>
+SQS::send_message_batch(SendMessageBatchInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return {BatchQueueNotFound, nullptr};
+  }
+  queue = send_partition(queue);
+
+  auto& entries = input->get_entries();
+  auto status = check_batch(entries);
+  if (status != BatchExecuted) {
+    return {status, nullptr};
+  }
+  size_t bytes = 0;
+  for (const auto& entry : entries) {
+    bytes += entry.message_body.size();
+  }
+  if (bytes > MAX_BATCH_BYTES) {
+    return {BatchTooLong, nullptr};
+  }
+
+  std::vector<Message> msgs;
+  std::vector<SendParams> params;
+  std::vector<DedupEntry> sent;
+  msgs.reserve(entries.size());
+  params.reserve(entries.size());
+  sent.reserve(entries.size());
+  for (auto& entry : entries) {
+    auto& m = msgs.emplace_back(
+        new_message(*queue, std::move(entry.message_body)));
+    params.push_back(send_params(*queue, m, entry.delay_seconds,
+                                 entry.message_group_id,
+                                 entry.message_deduplication_id));
+    sent.push_back(DedupEntry{m.message_id, m.md5_of_body});
+  }
+
+  std::vector<SendMessageStatus> statuses;
+  statuses.reserve(entries.size());
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  for (size_t i = 0; i < msgs.size(); i++) {
+    statuses.push_back(enqueue(*queue, std::move(msgs[i]), params[i], sent[i]));
+  }
+  serve_waiters(*queue, done);
+  schedule_wake(queue);
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+
+  auto res = std::make_unique<SendMessageBatchResponse>();
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto& id = entries[i].id;
+    switch (statuses[i]) {
+      case MessageSent:
+        res->successful.push_back(SendMessageBatchResultEntry{
+            id, format_uuid(sent[i].message_id),
+            format_digest(sent[i].md5_of_body)});
+        break;
+      case DelaySecondsInvalid:
+        res->failed.push_back(BatchResultErrorEntry{
+            id, true, "InvalidParameterValue",
+            "Value for parameter DelaySeconds is invalid."});
+        break;
+      case MessageGroupIdMissing:
+        res->failed.push_back(BatchResultErrorEntry{
+            id, true, "MissingParameter",
+            "The request must contain the parameter MessageGroupId."});
+        break;
+      case DeduplicationIdMissing:
+        res->failed.push_back(BatchResultErrorEntry{
+            id, true, "InvalidParameterValue",
+            "The queue should either have ContentBasedDeduplication enabled "
+            "or MessageDeduplicationId provided explicitly."});
+        break;
+      default:
+        res->failed.push_back(BatchResultErrorEntry{
+            id, true, "InvalidParameterValue",
+            "The message is longer than the queue allows."});
+    }
+  }
+  return {BatchExecuted, std::move(res)};
+}
+
+Message SQS::new_message(QueueState& queue, std::string&& body) {
   Message m;
-  auto id = uuid_generator();
-  m.message_id = boost::lexical_cast<std::string>(id);
-  m.body = msg->get_message_body();
-  m.md5_of_body = md5(m.body);
+  m.message_id = uuid_generator()();
+  m.receipt_handle = boost::uuids::nil_uuid();
+  m.body = pooled_body(queue.body_pool, std::move(body));
+  m.md5_of_body = md5(m.body.view());
   m.visible_at = 0;
-  queue->second.push_back(m);
-  mtx.unlock();
-  return std::make_unique<SendMessageResponse>(m.message_id, m.md5_of_body);
+  m.sent_at = now();
+  return m;
+}
+
+SendParams SQS::send_params(QueueState& queue, const Message& msg,
+                            std::optional<long> delay_seconds,
+                            std::optional<std::string> group_id,
+                            std::optional<std::string> deduplication_id) {
+  SendParams params{delay_seconds, {}, {}, {}};
+  if (!queue.fifo) {
+    return params;
+  }
+
+  params.message_group_id = std::move(group_id);
+  // hashed before taking the queue lock, whether the queue deduplicates by
+  // content is only known under it
+  if (!deduplication_id.has_value()) {
+    params.content_deduplication_id = sha256_hex(msg.body.view());
+  }
+  params.deduplication_id = std::move(deduplication_id);
+  return params;
+}
+
+SendMessageStatus SQS::enqueue(QueueState& queue, Message msg,
+                               const SendParams& params, DedupEntry& sent) {
+  auto& config = queue.config;
+  if ((long)msg.body.size() > config.maximum_message_size) {
+    return MessageTooLong;
+  }
+  auto delay = params.delay_seconds.value_or(config.delay_seconds);
+  if (delay < 0 || delay > MAX_DELAY_SECONDS) {
+    return DelaySecondsInvalid;
+  }
+
+  auto ts = now();
+  std::string group_id;
+  if (queue.fifo) {
+    // FIFO queues only delay messages through their DelaySeconds attribute
+    if (params.delay_seconds.has_value()) {
+      return DelaySecondsInvalid;
+    }
+    if (!params.message_group_id.has_value()) {
+      return MessageGroupIdMissing;
+    }
+    auto& deduplication_id = params.deduplication_id.has_value()
+                                 ? params.deduplication_id
+                                 : params.content_deduplication_id;
+    if (!params.deduplication_id.has_value() &&
+        !config.content_based_deduplication) {
+      return DeduplicationIdMissing;
+    }
+
+    auto first = queue.dedup.find(deduplication_id.value(), ts);
+    if (first.has_value()) {
+      sent = first.value();
+      return MessageSent;
+    }
+    queue.dedup.insert(deduplication_id.value(), sent, ts);
+    group_id = params.message_group_id.value();
+  }
+
+  if (delay > 0) {
+    msg.visible_at = ts + delay;
+    queue.messages.push_delayed(std::move(msg), ts, group_id);
+  } else {
+    queue.messages.push(std::move(msg), group_id);
+  }
+  return MessageSent;
 }
 
 int SQS::get_message_count(std::string& qurl) {
-  auto queue = queues.find(qurl);
-  if (queue == queues.end()) {
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
     return -1;
   }
 
-  return queue->second.size();
+  int count = 0;
+  for_each_partition(queue, [&count](const auto& partition) {
+    std::lock_guard partition_lock(partition->mtx);
+    count += partition->messages.size();
+  });
+  return count;
 }
 
 bool SQS::purge_queue(std::string qurl) {
-  mtx.lock();
-  auto queue = queues.find(qurl);
-  if (queue == queues.end()) {
-    mtx.unlock();
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
     return false;
   }
 
-  queue->second.clear();
-  mtx.unlock();
+  for_each_partition(queue, [this](const auto& partition) {
+    std::unique_lock partition_lock(partition->mtx);
+    auto detached = partition->messages.detach();
+    publish_counters(*partition);
+    partition_lock.unlock();
+    reclaimer.retire(std::move(detached));
+  });
   return true;
 }
 
-std::vector<Message> SQS::receive(std::string qurl, int count) {
-  mtx.lock();
-  auto queue = queues.find(qurl);
-  if (queue == queues.end() || queue->second.empty()) {
-    mtx.unlock();
+bool SQS::expire_messages(long ts) {
+  bool more = false;
+  // held for the whole pass, a range over the temporary would dangle
+  auto current = directory.load();
+  for (const auto& queue : current->states) {
+    if (queue == nullptr) {
+      continue;
+    }
+    for_each_partition(queue, [ts, &more](const auto& partition) {
+      if (partition->counters.reap_at > ts) {
+        return;
+      }
+      std::lock_guard partition_lock(partition->mtx);
+      auto sent_before = ts - partition->config.message_retention_period;
+      auto& messages = partition->messages;
+      messages.release(ts);
+      more |= messages.expire(sent_before, REAP_SLICE) == REAP_SLICE;
+      publish_counters(*partition);
+    });
+  }
+  return more;
+}
+
+void SQS::reap() {
+  auto at = Clock::now();
+  if (!expire_messages(now())) {
+    at += REAP_INTERVAL;
+  }
+  scheduler.schedule(at, [this]() { reap(); });
+}
+
+size_t SQS::pending_reclamation_bytes() { return reclaimer.pending_bytes(); }
+
+void SQS::drain_reclamation() { reclaimer.drain(); }
+
+std::vector<Message> SQS::receive(ReceiveMessageInput* input) {
+  if (check_receive(input) != MessagesReceived) {
+    return {};
+  }
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
     return {};
   }
 
-  std::vector<Message> messages;
-  auto total = 0;
-  auto ts = now();
+  auto count = input->get_max_number_of_messages().value_or(1);
+  if (queue->partitions.empty()) {
+    return receive_from(queue, count, input->get_visibility_timeout());
+  }
 
-  for (Message& msg : queue->second) {
-    if (msg.visible_at <= ts) {
-      msg.visible_at = ts + 30;
-      messages.push_back(msg);
-      total++;
+  std::vector<Message> msgs;
+  auto& partitions = queue->partitions;
+  auto start = next_partition(partitions.size());
+  for (size_t i = 0; i < partitions.size() && (int)msgs.size() < count; i++) {
+    auto partition = partitions[(start + i) % partitions.size()];
+    auto received = receive_from(partition, count - msgs.size(),
+                                 input->get_visibility_timeout());
+    std::move(received.begin(), received.end(), std::back_inserter(msgs));
+  }
+  return msgs;
+}
+
+std::vector<Message> SQS::receive_from(
+    const std::shared_ptr<QueueState>& queue, int count,
+    std::optional<int> visibility_timeout) {
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  serve_waiters(*queue, done);
+  std::vector<Message> msgs;
+  if (queue->waiters.empty()) {
+    msgs = receive_messages(
+        *queue, count,
+        visibility_timeout.value_or(queue->config.visibility_timeout), done);
+  }
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+  return msgs;
+}
+
+ReceiveStatus SQS::receive_async(ReceiveMessageInput* input,
+                                ReceiveCallback callback) {
+  auto status = check_receive(input);
+  if (status != MessagesReceived) {
+    return status;
+  }
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return ReceiveQueueNotFound;
+  }
+  if (queue->partitions.empty()) {
+    return receive_async_from(queue, input, callback);
+  }
+
+  // the partitions are drained in turn, the last one tried is waited on
+  auto count = input->get_max_number_of_messages().value_or(1);
+  std::vector<Message> msgs;
+  auto& partitions = queue->partitions;
+  auto start = next_partition(partitions.size());
+  for (size_t i = 0; i + 1 < partitions.size() && (int)msgs.size() < count;
+       i++) {
+    auto partition = partitions[(start + i) % partitions.size()];
+    auto received = receive_from(partition, count - msgs.size(),
+                                 input->get_visibility_timeout());
+    std::move(received.begin(), received.end(), std::back_inserter(msgs));
+  }
+  if (!msgs.empty()) {
+    callback(std::move(msgs));
+    return MessagesReceived;
+  }
+  auto last = (start + partitions.size() - 1) % partitions.size();
+  return receive_async_from(partitions[last], input, callback);
+}
+
+ReceiveStatus SQS::receive_async_from(const std::shared_ptr<QueueState>& queue,
+                                      ReceiveMessageInput* input,
+                                      ReceiveCallback& callback) {
+  auto count = input->get_max_number_of_messages().value_or(1);
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  auto& config = queue->config;
+  auto visibility_timeout =
+      input->get_visibility_timeout().value_or(config.visibility_timeout);
+  auto wait_time = std::min(input->get_wait_time_seconds().value_or(
+                                config.receive_message_wait_time_seconds),
+                            MAX_WAIT_TIME_SECONDS);
+
+  // messages that became visible since the last wake go to the parked
+  // receives first, a new one does not overtake them
+  serve_waiters(*queue, done);
+  std::vector<Message> msgs;
+  if (queue->waiters.empty()) {
+    msgs = receive_messages(*queue, count, visibility_timeout, done);
+  }
+
+  auto status = MessagesReceived;
+  if (msgs.empty() && wait_time > 0) {
+    if (queue->waiters.size() >= MAX_WAITERS_PER_QUEUE) {
+      status = TooManyWaiters;
+    } else {
+      auto deadline = Clock::now() + std::chrono::seconds(wait_time);
+      queue->waiters.push_back(
+          Waiter{count, visibility_timeout, deadline, std::move(callback)});
+      schedule_wake(queue);
+      status = ReceiveParked;
+    }
+  }
+  publish_counters(*queue);
+  queue_lock.unlock();
+
+  complete(done);
+  if (status == MessagesReceived) {
+    callback(std::move(msgs));
+  }
+  return status;
+}
+
+std::vector<Message> SQS::receive_messages(QueueState& queue, int count,
+                                           long visibility_timeout,
+                                           Completions& done) {
+  uint32_t max_receive_count = 0;
+  auto& policy = queue.config.redrive_policy;
+  if (policy.has_value()) {
+    // without its dead-letter queue the source keeps its messages
+    auto dead_letter_queue =
+        find_queue_by_name(policy->dead_letter_queue_name);
+    if (dead_letter_queue.has_value() &&
+        dead_letter_queue->name != queue.name) {
+      done.dead_letter_queue = std::move(dead_letter_queue);
+      max_receive_count = policy->max_receive_count;
     }
+  }
+  return queue.messages.receive(count, now(), visibility_timeout,
+                                uuid_generator(), max_receive_count,
+                                &done.dead_letters);
+}
 
-    if (total == count) {
+void SQS::serve_waiters(QueueState& queue, Completions& done) {
+  while (!queue.waiters.empty()) {
+    auto& waiter = queue.waiters.front();
+    // a waiter that asks for nothing would hold up the ones behind it, it
+    // is answered empty instead
+    if (waiter.count < 1) {
+      done.receives.emplace_back(std::move(waiter.callback),
+                                 std::vector<Message>());
+      queue.waiters.pop_front();
+      continue;
+    }
+    // nothing left for the oldest waiter is nothing left for any
+    auto msgs = receive_messages(queue, waiter.count,
+                                 waiter.visibility_timeout, done);
+    if (msgs.empty()) {
       break;
     }
+    done.receives.emplace_back(std::move(waiter.callback), std::move(msgs));
+    queue.waiters.pop_front();
   }
-  mtx.unlock();
-  return messages;
 }
 
-bool SQS::delete_message(DeleteMessageInput* input) {
-  mtx.lock();
-  auto queue = queues.find(input->get_queue_url());
-  if (queue == queues.end()) {
-    mtx.unlock();
-    return false;
+void SQS::schedule_wake(const std::shared_ptr<QueueState>& queue) {
+  if (queue->waiters.empty()) {
+    return;
+  }
+
+  auto at = Clock::time_point::max();
+  for (const auto& waiter : queue->waiters) {
+    at = std::min(at, waiter.deadline);
+  }
+  auto visible_at = queue->messages.next_visible_at();
+  if (visible_at.has_value()) {
+    at = std::min(at, Clock::from_time_t(visible_at.value()));
+  }
+
+  // a wake already due earlier reschedules itself when it runs
+  if (at < queue->wake_at) {
+    queue->wake_at = at;
+    std::weak_ptr<QueueState> weak_queue = queue;
+    scheduler.schedule(at, [this, weak_queue]() { wake(weak_queue); });
+  }
+}
+
+void SQS::wake(const std::weak_ptr<QueueState>& weak_queue) {
+  auto queue = weak_queue.lock();
+  if (queue == nullptr) {
+    return;
+  }
+
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  auto ts = Clock::now();
+  // wakes superseded by an earlier one leave the schedule to it
+  if (queue->wake_at <= ts) {
+    queue->wake_at = Clock::time_point::max();
+  }
+
+  serve_waiters(*queue, done);
+  std::erase_if(queue->waiters, [&done, ts](Waiter& waiter) {
+    if (waiter.deadline > ts) {
+      return false;
+    }
+    done.receives.emplace_back(std::move(waiter.callback),
+                               std::vector<Message>());
+    return true;
+  });
+  schedule_wake(queue);
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+}
+
+void SQS::complete(Completions& done) {
+  for (auto& [callback, msgs] : done.receives) {
+    callback(std::move(msgs));
+  }
+  if (!done.dead_letters.empty()) {
+    redrive(done.dead_letter_queue.value(), std::move(done.dead_letters));
+  }
+}
+
+void SQS::redrive(const NamedQueue& queue,
+                  std::vector<MovedMessage> dead_letters) {
+  if (queue.state != nullptr) {
+    redrive(queue.state, std::move(dead_letters));
+    return;
+  }
+  // the owner looks the queue up again, the messages are lost with it if it
+  // was deleted meanwhile
+  auto& owner = shards[queue.shard];
+  owner.mailbox->post([sqs = owner.sqs, name = queue.name,
+                       dead_letters = std::move(dead_letters)]() mutable {
+    auto queue = sqs->directory.load()->find_queue_by_name(name);
+    if (queue != nullptr) {
+      sqs->redrive(queue, std::move(dead_letters));
+    }
+  });
+}
+
+void SQS::redrive(const std::shared_ptr<QueueState>& queue,
+                  std::vector<MovedMessage> dead_letters) {
+  auto partition = send_partition(queue);
+  Completions done;
+  std::unique_lock queue_lock(partition->mtx);
+  for (auto& dead_letter : dead_letters) {
+    auto& msg = dead_letter.message;
+    msg.receipt_handle = boost::uuids::nil_uuid();
+    msg.visible_at = 0;
+    // retention restarts in the new queue, which keeps its arrivals ordered
+    msg.sent_at = now();
+    partition->messages.push(std::move(msg),
+                             queue->fifo ? dead_letter.group_id : "");
+  }
+  serve_waiters(*partition, done);
+  schedule_wake(partition);
+  publish_counters(*partition);
+  queue_lock.unlock();
+  complete(done);
+}
+
+bool SQS::valid_redrive_policy(const QueueConfig& config,
+                               const std::string& qname) {
+  auto& policy = config.redrive_policy;
+  if (!policy.has_value()) {
+    return true;
+  }
+  auto dead_letter_queue = find_queue_by_name(policy->dead_letter_queue_name);
+  // the dead-letter queue must exist and be of the same type
+  return dead_letter_queue.has_value() && dead_letter_queue->name != qname &&
+         dead_letter_queue->fifo == config.fifo_queue;
+}
+
+void SQS::index_dead_letter_source(const std::string& qname,
+                                   const std::optional<RedrivePolicy>& before,
+                                   const std::optional<RedrivePolicy>& after) {
+  // every shard indexes the sources of all of them
+  auto update = [qname, before, after](SQS& sqs) {
+    std::lock_guard lock(sqs.redrive_mtx);
+    auto& index = sqs.dead_letter_sources;
+    if (before.has_value()) {
+      auto sources = index.find(before->dead_letter_queue_name);
+      if (sources != index.end()) {
+        sources->second.erase(qname);
+        if (sources->second.empty()) {
+          index.erase(sources);
+        }
+      }
+    }
+    if (after.has_value()) {
+      index[after->dead_letter_queue_name].insert(qname);
+    }
+  };
+  update(*this);
+  replicate(update);
+}
+
+std::optional<std::vector<std::string>> SQS::list_dead_letter_source_queues(
+    std::string_view qurl) {
+  auto queue = directory.load()->find_queue(qurl);
+  if (queue == nullptr) {
+    return {};
+  }
+
+  std::vector<std::string> qurls;
+  for (const auto& qname : dead_letter_source_names(queue->name)) {
+    auto source = find_queue_by_name(qname);
+    if (source.has_value()) {
+      qurls.push_back(source->url);
+    }
+  }
+  return qurls;
+}
+
+std::vector<std::string> SQS::dead_letter_source_names(
+    std::string_view qname) {
+  std::lock_guard lock(redrive_mtx);
+  auto sources = dead_letter_sources.find(qname);
+  if (sources == dead_letter_sources.end()) {
+    return {};
+  }
+  return {sources->second.begin(), sources->second.end()};
+}
+
+std::string SQS::queue_arn(const std::string& qname) {
+  // the endpoint ends in the account number
+  auto account = endpoint.substr(endpoint.rfind('/') + 1);
+  return "arn:aws:sqs:us-east-1:" + account + ":" + qname;
+}
+
+DeleteMessageStatus SQS::delete_message(DeleteMessageInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return QueueNotFound;
+  }
+
+  auto receipt_handle = parse_uuid(input->get_receipt_handle());
+  if (!receipt_handle.has_value()) {
+    return ReceiptHandleInvalid;
+  }
+
+  queue = receipt_partition(queue, receipt_handle.value());
+  if (queue == nullptr) {
+    return ReceiptHandleInvalid;
+  }
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  auto deleted = queue->messages.remove(receipt_handle.value(), now());
+  if (!deleted) {
+    return ReceiptHandleInvalid;
+  }
+  // deleting the last in-flight message of a group unlocks the rest of it
+  if (queue->fifo) {
+    serve_waiters(*queue, done);
+    schedule_wake(queue);
+  }
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+  return MessageDeleted;
+}
+
+ChangeMessageVisibilityStatus SQS::change_message_visibility(
+    ChangeMessageVisibilityInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return VisibilityQueueNotFound;
+  }
+
+  auto visibility_timeout = input->get_visibility_timeout();
+  if (visibility_timeout < 0 || visibility_timeout > MAX_VISIBILITY_TIMEOUT) {
+    return VisibilityTimeoutInvalid;
   }
+  auto receipt_handle = parse_uuid(input->get_receipt_handle());
+  if (!receipt_handle.has_value()) {
+    return VisibilityReceiptHandleInvalid;
+  }
+  queue = receipt_partition(queue, receipt_handle.value());
+  if (queue == nullptr) {
+    return VisibilityReceiptHandleInvalid;
+  }
+
+  Completions done;
+  std::unique_lock queue_lock(queue->mtx);
+  auto changed = queue->messages.change_visibility(receipt_handle.value(),
+                                                   now(), visibility_timeout);
+  if (!changed) {
+    return VisibilityReceiptHandleInvalid;
+  }
+  serve_waiters(*queue, done);
+  schedule_wake(queue);
+  publish_counters(*queue);
+  queue_lock.unlock();
+  complete(done);
+  return VisibilityChanged;
+}
+
+std::pair<BatchStatus, std::unique_ptr<BatchResponse>>
+SQS::delete_message_batch(DeleteMessageBatchInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return {BatchQueueNotFound, nullptr};
+  }
+
+  auto& entries = input->get_entries();
+  auto status = check_batch(entries);
+  if (status != BatchExecuted) {
+    return {status, nullptr};
+  }
+  std::vector<std::optional<boost::uuids::uuid>> receipt_handles;
+  std::vector<std::shared_ptr<QueueState>> owners;
+  for (const auto& entry : entries) {
+    auto& receipt_handle =
+        receipt_handles.emplace_back(parse_uuid(entry.receipt_handle));
+    owners.push_back(receipt_handle.has_value()
+                         ? receipt_partition(queue, receipt_handle.value())
+                         : nullptr);
+  }
+
+  // each partition holding entries is locked once
+  std::vector<bool> deleted(entries.size());
+  auto ts = now();
+  for_each_partition(queue, [&](const auto& partition) {
+    if (std::find(owners.begin(), owners.end(), partition) == owners.end()) {
+      return;
+    }
+    Completions done;
+    std::unique_lock partition_lock(partition->mtx);
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (owners[i] == partition) {
+        deleted[i] =
+            partition->messages.remove(receipt_handles[i].value(), ts);
+      }
+    }
+    if (partition->fifo) {
+      serve_waiters(*partition, done);
+      schedule_wake(partition);
+    }
+    publish_counters(*partition);
+    partition_lock.unlock();
+    complete(done);
+  });
+
+  auto res = std::make_unique<BatchResponse>();
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (deleted[i]) {
+      res->successful.push_back(entries[i].id);
+    } else {
+      res->failed.push_back(invalid_receipt_handle(entries[i].id));
+    }
+  }
+  return {BatchExecuted, std::move(res)};
+}
+
+std::pair<BatchStatus, std::unique_ptr<BatchResponse>>
+SQS::change_message_visibility_batch(ChangeMessageVisibilityBatchInput* input) {
+  auto queue = directory.load()->find_queue(input->get_queue_url());
+  if (queue == nullptr) {
+    return {BatchQueueNotFound, nullptr};
+  }
+
+  auto& entries = input->get_entries();
+  auto status = check_batch(entries);
+  if (status != BatchExecuted) {
+    return {status, nullptr};
+  }
+  std::vector<std::optional<boost::uuids::uuid>> receipt_handles;
+  std::vector<std::shared_ptr<QueueState>> owners;
+  for (const auto& entry : entries) {
+    auto& receipt_handle =
+        receipt_handles.emplace_back(parse_uuid(entry.receipt_handle));
+    auto valid_timeout = entry.visibility_timeout >= 0 &&
+                         entry.visibility_timeout <= MAX_VISIBILITY_TIMEOUT;
+    owners.push_back(valid_timeout && receipt_handle.has_value()
+                         ? receipt_partition(queue, receipt_handle.value())
+                         : nullptr);
+  }
+
+  // each partition holding entries is locked once
+  std::vector<bool> changed(entries.size());
+  auto ts = now();
+  for_each_partition(queue, [&](const auto& partition) {
+    if (std::find(owners.begin(), owners.end(), partition) == owners.end()) {
+      return;
+    }
+    Completions done;
+    std::unique_lock partition_lock(partition->mtx);
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (owners[i] == partition) {
+        changed[i] = partition->messages.change_visibility(
+            receipt_handles[i].value(), ts, entries[i].visibility_timeout);
+      }
+    }
+    // messages released with a timeout of 0 go to parked receives right away
+    serve_waiters(*partition, done);
+    schedule_wake(partition);
+    publish_counters(*partition);
+    partition_lock.unlock();
+    complete(done);
+  });
+
+  auto res = std::make_unique<BatchResponse>();
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto& entry = entries[i];
+    if (entry.visibility_timeout < 0 ||
+        entry.visibility_timeout > MAX_VISIBILITY_TIMEOUT) {
+      res->failed.push_back(BatchResultErrorEntry{
+          entry.id, true, "InvalidParameterValue",
+          "Value for parameter VisibilityTimeout is invalid."});
+    } else if (changed[i]) {
+      res->successful.push_back(entry.id);
+    } else {
+      res->failed.push_back(invalid_receipt_handle(entry.id));
+    }
+  }
+  return {BatchExecuted, std::move(res)};
+}
+
+std::pair<StartMoveTaskStatus, std::unique_ptr<StartMessageMoveTaskResponse>>
+SQS::start_message_move_task(StartMessageMoveTaskInput* input) {
+  auto current = directory.load();
+  auto source_name = queue_name_from_arn(input->get_source_arn());
+  auto source = source_name.has_value()
+                    ? current->find_queue_by_name(source_name.value())
+                    : nullptr;
+  if (source == nullptr) {
+    return {MoveSourceNotFound, nullptr};
+  }
+
+  auto sources = dead_letter_source_names(source->name);
+  if (sources.empty()) {
+    return {MoveSourceNotDeadLetterQueue, nullptr};
+  }
+  std::optional<std::string> destination_name;
+  auto& destination_arn = input->get_destination_arn();
+  if (destination_arn.has_value()) {
+    destination_name = queue_name_from_arn(destination_arn.value());
+  } else if (sources.size() == 1) {
+    // messages do not record where they were dead-lettered from, so only a
+    // single source is unambiguous
+    destination_name = sources[0];
+  }
+
+  auto destination = destination_name.has_value()
+                         ? find_queue_by_name(destination_name.value())
+                         : std::nullopt;
+  if (!destination.has_value() || destination->name == source->name) {
+    return {MoveDestinationInvalid, nullptr};
+  }
+  auto& rate = input->get_max_number_of_messages_per_second();
+  if (rate.has_value() &&
+      (rate.value() < 1 || rate.value() > MAX_MOVE_TASK_RATE)) {
+    return {MoveRateInvalid, nullptr};
+  }
+
+  long to_move = load_counts(source).visible;
 
-  auto& msgs = queue->second;
-  for (auto it = msgs.begin(); it != msgs.end(); it++) {
-    if (it->message_id == input->get_receipt_handle()) {
-      msgs.erase(it);
-      mtx.unlock();
-      return true;
+  auto task = std::make_shared<MoveTask>();
+  task->source_name = source->name;
+  task->destination_name = destination->name;
+  auto& result = task->result;
+  auto task_handle = uuid_generator()();
+  if (!shards.empty()) {
+    // cancels are routed to this shard by the handle
+    task_handle.data[0] = shard;
+  }
+  result.task_handle = format_uuid(task_handle);
+  result.status = "RUNNING";
+  result.source_arn = queue_arn(source->name);
+  result.destination_arn = queue_arn(destination->name);
+  result.max_number_of_messages_per_second = rate;
+  result.approximate_number_of_messages_moved = 0;
+  result.approximate_number_of_messages_to_move = to_move;
+  result.started_timestamp =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          Clock::now().time_since_epoch())
+          .count();
+
+  std::unique_lock move_lock(move_tasks_mtx);
+  auto& tasks = move_tasks[source->name];
+  if (!tasks.empty() && tasks.front()->result.status == "RUNNING") {
+    return {MoveTaskAlreadyRunning, nullptr};
+  }
+  tasks.push_front(task);
+  if (tasks.size() > MOVE_TASKS_KEPT) {
+    tasks.pop_back();
+  }
+  running_move_tasks[result.task_handle] = task;
+  auto res = std::make_unique<StartMessageMoveTaskResponse>(result.task_handle);
+  move_lock.unlock();
+
+  scheduler.schedule(Clock::now(), [this, task]() { run_move_task(task); });
+  return {MoveTaskStarted, std::move(res)};
+}
+
+void SQS::run_move_task(const std::shared_ptr<MoveTask>& task) {
+  auto started = Clock::now();
+  std::unique_lock move_lock(move_tasks_mtx);
+  if (task->result.status != "RUNNING") {
+    return;
+  }
+  auto rate = task->result.max_number_of_messages_per_second;
+  auto remaining = task->result.approximate_number_of_messages_to_move -
+                   task->result.approximate_number_of_messages_moved;
+  move_lock.unlock();
+
+  auto source = directory.load()->find_queue_by_name(task->source_name);
+  auto destination = find_queue_by_name(task->destination_name);
+  if (source == nullptr || !destination.has_value()) {
+    finish_move_task(*task, "FAILED", "The queue was deleted.");
+    return;
+  }
+
+  // messages sent to the source after the start are left there
+  auto chunk = std::min<long>(MOVE_TASK_CHUNK, remaining);
+  if (rate.has_value()) {
+    chunk = std::min(chunk, rate.value());
+  }
+  std::vector<MovedMessage> moved;
+  for_each_partition(source, [this, chunk, &moved](const auto& partition) {
+    if ((long)moved.size() >= chunk) {
+      return;
     }
+    std::unique_lock partition_lock(partition->mtx);
+    auto taken = partition->messages.take(chunk - moved.size(), now());
+    publish_counters(*partition);
+    partition_lock.unlock();
+    std::move(taken.begin(), taken.end(), std::back_inserter(moved));
+  });
+  if (moved.empty()) {
+    finish_move_task(*task, "COMPLETED", "");
+    return;
+  }
+
+  long count = moved.size();
+  for (auto& msg : moved) {
+    msg.message.receive_count = 0;
+  }
+  redrive(destination.value(), std::move(moved));
+
+  move_lock.lock();
+  task->result.approximate_number_of_messages_moved += count;
+  move_lock.unlock();
+  auto at = started;
+  if (rate.has_value()) {
+    at += std::chrono::microseconds(count * 1000000 / rate.value());
   }
-  mtx.unlock();
-  return false;
+  scheduler.schedule(at, [this, task]() { run_move_task(task); });
 }
 
-std::unique_ptr<FullQueueDataResponse> SQS::get_queue_data(std::string qname) {
-  auto qurl = new_queue_url(qname);
-  auto queue = queues.find(qurl);
-  if (queue == queues.end()) {
+void SQS::finish_move_task(MoveTask& task, std::string status,
+                           std::string failure_reason) {
+  std::lock_guard move_lock(move_tasks_mtx);
+  if (task.result.status != "RUNNING") {
+    return;
+  }
+  running_move_tasks.erase(task.result.task_handle);
+  task.result.task_handle.clear();
+  task.result.status = std::move(status);
+  task.result.failure_reason = std::move(failure_reason);
+}
+
+std::optional<std::unique_ptr<CancelMessageMoveTaskResponse>>
+SQS::cancel_message_move_task(CancelMessageMoveTaskInput* input) {
+  std::unique_lock move_lock(move_tasks_mtx);
+  auto task = running_move_tasks.find(input->get_task_handle());
+  if (task == running_move_tasks.end()) {
+    return {};
+  }
+  auto& result = task->second->result;
+  result.task_handle.clear();
+  result.status = "CANCELLED";
+  auto moved = result.approximate_number_of_messages_moved;
+  running_move_tasks.erase(task);
+  return std::make_unique<CancelMessageMoveTaskResponse>(moved);
+}
+
+std::optional<std::unique_ptr<ListMessageMoveTasksResponse>>
+SQS::list_message_move_tasks(ListMessageMoveTasksInput* input) {
+  auto source_name = queue_name_from_arn(input->get_source_arn());
+  if (!source_name.has_value() ||
+      directory.load()->find_queue_by_name(source_name.value()) == nullptr) {
+    return {};
+  }
+
+  size_t max_results = std::clamp(input->get_max_results().value_or(1), 1,
+                                  (int)MOVE_TASKS_KEPT);
+  auto res = std::make_unique<ListMessageMoveTasksResponse>();
+  std::lock_guard move_lock(move_tasks_mtx);
+  auto tasks = move_tasks.find(source_name.value());
+  if (tasks == move_tasks.end()) {
+    return res;
+  }
+  for (const auto& task : tasks->second) {
+    if (res->results.size() == max_results) {
+      break;
+    }
+    res->results.push_back(task->result);
+  }
+  return res;
+}
+
+std::unique_ptr<FullQueueDataResponse> SQS::get_queue_data(
+    std::string_view qname) {
+  auto queue = directory.load()->find_queue_by_name(qname);
+  if (queue == nullptr) {
     return nullptr;
   }
 
   auto info = FullQueueDataResponse();
-  info.queue_name = qname;
-  info.queue_url = qurl;
-  for (const auto& msg : queue->second) {
+  info.queue_name = queue->name;
+  info.queue_url = queue->url;
+
+  std::lock_guard queue_lock(queue->mtx);
+  info.attributes = queue->config.to_attributes();
+  info.body_pool_stats = queue->body_pool->stats();
+  auto add_message = [&info](const Message& msg) {
     ReceivedMessageResponse res_msg;
-    res_msg.message_id = msg.message_id;
-    res_msg.receipt_handle = msg.message_id;
-    res_msg.md5_of_body = msg.md5_of_body;
+    res_msg.message_id = format_uuid(msg.message_id);
+    res_msg.receipt_handle = format_uuid(msg.receipt_handle);
+    res_msg.md5_of_body = format_digest(msg.md5_of_body);
     res_msg.body = msg.body;
+    res_msg.receive_count = msg.receive_count;
     info.messages.push_back(res_msg);
+  };
+  queue->messages.for_each(add_message);
+  for (const auto& partition : queue->partitions) {
+    std::lock_guard partition_lock(partition->mtx);
+    partition->messages.for_each(add_message);
+    auto stats = partition->body_pool->stats();
+    info.body_pool_stats.bytes_reserved += stats.bytes_reserved;
+    info.body_pool_stats.bytes_in_use += stats.bytes_in_use;
+    info.body_pool_stats.blocks_in_use += stats.blocks_in_use;
   }
-  info.tags = queue_tags[qurl];
-  info.attributes = queue_attrs[qurl];
+  info.tags = queue->tags;
   return std::make_unique<FullQueueDataResponse>(info);
 }
 
+void SQS::publish_attributes(QueueState& queue, long modified_at) {
+  auto attrs = queue.config.to_attributes();
+  attrs["CreatedTimestamp"] = std::to_string(queue.created_at);
+  attrs["LastModifiedTimestamp"] = std::to_string(modified_at);
+  attrs["QueueArn"] = queue_arn(queue.name);
+  queue.attributes =
+      std::make_shared<const std::map<std::string, std::string>>(
+          std::move(attrs));
+}
+
 long SQS::now() { return std::time(nullptr); }
 
-std::string SQS::md5(std::string& content) {
-  // copied over from stack overflow
-  EVP_MD_CTX* context = EVP_MD_CTX_new();
-  const EVP_MD* md = EVP_md5();
-  unsigned char md_value[EVP_MAX_MD_SIZE];
+boost::uuids::random_generator& SQS::uuid_generator() {
+  // the generator is not thread safe, every handler thread gets its own
+  thread_local boost::uuids::random_generator gen;
+  return gen;
+}
+
+// Digests are fetched once. Passing EVP_md5() and the like fetches them from
+// the provider store on every call, which handler threads contend on.
+static const EVP_MD* MD5_DIGEST = EVP_MD_fetch(NULL, "MD5", NULL);
+static const EVP_MD* SHA256_DIGEST = EVP_MD_fetch(NULL, "SHA256", NULL);
+
+Digest SQS::md5(std::string_view content) {
+  Digest digest;
   unsigned int md_len;
-  std::string output;
+  EVP_Digest(content.data(), content.size(), digest.data(), &md_len,
+             MD5_DIGEST, NULL);
+  return digest;
+}
 
-  EVP_DigestInit_ex2(context, md, NULL);
-  EVP_DigestUpdate(context, content.c_str(), content.length());
-  EVP_DigestFinal_ex(context, md_value, &md_len);
-  EVP_MD_CTX_free(context);
+std::string SQS::sha256_hex(std::string_view content) {
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+  EVP_Digest(content.data(), content.size(), digest, &md_len, SHA256_DIGEST,
+             NULL);
 
-  output.resize(md_len * 2);
-  for (unsigned int i = 0; i < md_len; ++i)
-    std::sprintf(&output[i * 2], "%02x", md_value[i]);
-  return output;
+  static const char* hex = "0123456789abcdef";
+  std::string res;
+  res.reserve(2 * md_len);
+  for (unsigned int i = 0; i < md_len; i++) {
+    res.push_back(hex[digest[i] >> 4]);
+    res.push_back(hex[digest[i] & 0xf]);
+  }
+  return res;
 }
 }  // namespace sqscpp
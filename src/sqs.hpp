@@ -1,53 +1,442 @@
 #ifndef SQSCPP_SQS_H
 #define SQSCPP_SQS_H
 
+#include <atomic>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "body_pool.hpp"
+#include "dedup_window.hpp"
+#include "mailbox.hpp"
 #include "protocol.hpp"
+#include "queue.hpp"
+#include "queue_config.hpp"
+#include "reclaimer.hpp"
+#include "scheduler.hpp"
 
 namespace sqscpp {
-struct Message {
-  std::string message_id;
-  std::string md5_of_body;
-  std::string body;
-  long visible_at;
+enum DeleteMessageStatus {
+  MessageDeleted,
+  QueueNotFound,
+  ReceiptHandleInvalid
 };
 
+enum SendMessageStatus {
+  MessageSent,
+  SendQueueNotFound,
+  MessageTooLong,
+  DelaySecondsInvalid,
+  MessageGroupIdMissing,
+  DeduplicationIdMissing
+};
+
+enum SetQueueAttributesStatus {
+  AttributesSet,
+  AttributesQueueNotFound,
+  AttributeValueInvalid
+};
+
+enum ChangeMessageVisibilityStatus {
+  VisibilityChanged,
+  VisibilityQueueNotFound,
+  VisibilityReceiptHandleInvalid,
+  VisibilityTimeoutInvalid
+};
+
+enum BatchStatus {
+  BatchExecuted,
+  BatchQueueNotFound,
+  BatchEmpty,
+  BatchTooManyEntries,
+  BatchIdsNotDistinct,
+  BatchEntryIdInvalid,
+  BatchTooLong
+};
+
+enum ReceiveStatus {
+  MessagesReceived,
+  ReceiveQueueNotFound,
+  ReceiveParked,
+  TooManyWaiters,
+  MaxNumberOfMessagesInvalid,
+  WaitTimeSecondsInvalid,
+  ReceiveVisibilityTimeoutInvalid
+};
+
+enum ListQueuesStatus { QueuesListed, MaxResultsInvalid };
+
+enum StartMoveTaskStatus {
+  MoveTaskStarted,
+  MoveSourceNotFound,
+  MoveSourceNotDeadLetterQueue,
+  MoveDestinationInvalid,
+  MoveRateInvalid,
+  MoveTaskAlreadyRunning
+};
+
+using QueueId = uint32_t;
+
+// longest a receive may wait for messages, as in AWS
+const long MAX_WAIT_TIME_SECONDS = 20;
+// longest a message may be delayed, as in AWS
+const long MAX_DELAY_SECONDS = 900;
+const long MAX_VISIBILITY_TIMEOUT = 43200;
+// messages a single receive returns at most, as in AWS
+const int MAX_RECEIVE_MESSAGES = 10;
+// queues a single ListQueues returns at most, as in AWS
+const int MAX_LIST_QUEUES_RESULTS = 1000;
+// limits of a single batch request, as in AWS
+const size_t MAX_BATCH_ENTRIES = 10;
+const size_t MAX_BATCH_BYTES = 262144;
+// parked receives a single queue accepts before turning new ones away
+const size_t MAX_WAITERS_PER_QUEUE = 1024;
+// messages a move task takes per acquisition of the source queue lock
+const size_t MOVE_TASK_CHUNK = 100;
+const long MAX_MOVE_TASK_RATE = 500;
+// move tasks listed per source queue, older ones are forgotten
+const size_t MOVE_TASKS_KEPT = 10;
+// messages expired per acquisition of a queue lock
+const size_t REAP_SLICE = 1024;
+const auto REAP_INTERVAL = std::chrono::seconds(1);
+
+// Index of the shard owning the queue named `qname` among `shards`.
+size_t shard_of(std::string_view qname, size_t shards);
+// Index of the shard running the move task with `task_handle`, nothing for
+// handles no shard issued.
+std::optional<size_t> move_task_shard(std::string_view task_handle,
+                                      size_t shards);
+
+// Parameters of a single send besides the message itself.
+struct SendParams {
+  std::optional<long> delay_seconds;
+  std::optional<std::string> message_group_id;
+  std::optional<std::string> deduplication_id;
+  // SHA-256 of the body, set for FIFO sends without a deduplication id
+  std::optional<std::string> content_deduplication_id;
+};
+
+// Completes a receive. Called exactly once, without any lock held, with the
+// received messages, which are empty when the wait expired or the queue was
+// deleted.
+using ReceiveCallback = std::function<void(std::vector<Message>)>;
+
+// A receive parked until messages become visible or its deadline passes.
+struct Waiter {
+  int count;
+  long visibility_timeout;
+  Clock::time_point deadline;
+  ReceiveCallback callback;
+};
+
+// Approximate message counts of a queue, published whenever its messages
+// change so that they can be read without the queue lock.
+struct QueueCounters {
+  std::atomic<size_t> visible = 0;
+  std::atomic<size_t> not_visible = 0;
+  std::atomic<size_t> delayed = 0;
+  // sent_at of the oldest message that is not delayed, 0 for none
+  std::atomic<long> oldest_sent_at = 0;
+  // receives parked on the queue
+  std::atomic<size_t> waiters = 0;
+  // earliest time a message expires or may become visible, LONG_MAX for
+  // none, the reaper leaves the queue alone until then
+  std::atomic<long> reap_at = std::numeric_limits<long>::max();
+};
+
+// Everything the server keeps about one queue. `mtx` guards the config, the
+// messages, the deduplication window, the tags and the waiters. `counters`
+// and `attributes` are published under it and read without it, the remaining
+// fields are fixed at creation.
+//
+// A striped queue keeps its messages in `partitions`, QueueStates of their
+// own with a copy of the config, and leaves its own `messages` empty. The
+// partitions are not in the directory and their receipt handles are tagged
+// with their index.
+struct QueueState {
+  QueueId id;
+  std::string name;
+  std::string url;
+  long created_at;
+  bool fifo;
+  std::shared_ptr<BodyPool> body_pool;
+
+  std::mutex mtx;
+  QueueConfig config;
+  Queue messages;
+  DedupWindow dedup;
+  std::map<std::string, std::string> tags;
+  // served oldest first
+  std::deque<Waiter> waiters;
+  // earliest wake up scheduled for the waiters, max() when there is none
+  Clock::time_point wake_at = Clock::time_point::max();
+
+  QueueCounters counters;
+  // the config's attributes plus the fixed ones, replaced on every change
+  std::atomic<std::shared_ptr<const std::map<std::string, std::string>>>
+      attributes;
+  std::vector<std::shared_ptr<QueueState>> partitions;
+};
+
+// Message move task. `result` is guarded by SQS::move_tasks_mtx, the queue
+// names are fixed.
+struct MoveTask {
+  MessageMoveTaskResult result;
+  std::string source_name;
+  std::string destination_name;
+};
+
+// Immutable snapshot of all queues. Queue URLs and names are interned into
+// QueueId once, queues are addressed by id afterwards. Lookups accept
+// std::string_view.
+struct QueueDirectory {
+  std::map<std::string, QueueId, std::less<>> ids_by_url;
+  std::map<std::string, QueueId, std::less<>> ids_by_name;
+  // indexed by QueueId, null for ids of deleted queues
+  std::vector<std::shared_ptr<QueueState>> states;
+  std::vector<QueueId> free_ids;
+
+  std::shared_ptr<QueueState> find_queue(std::string_view qurl) const;
+  std::shared_ptr<QueueState> find_queue_by_name(std::string_view qname) const;
+};
+
+class SQS;
+
+// The queues of a shard and the mailbox the other shards post to it.
+struct Shard {
+  SQS* sqs;
+  Mailbox* mailbox;
+};
+
+// Locking: the queue directory is published as an immutable snapshot that
+// readers load without locking. create_queue and delete_queue serialise on
+// `directory_mtx`, copy the snapshot, modify the copy and swap it in. Every
+// other operation locks only the mutex of the QueueState it works on.
+//
+// Purging or deleting a queue only detaches its messages under the lock and
+// hands them to `reclaimer`, which frees them on its own thread.
+//
+// Receives finding no messages are parked as waiters of their queue. Sends
+// hand messages to the waiters directly, while `scheduler` wakes a queue
+// when a waiter's deadline passes or an in-flight message becomes visible
+// again. Completed receives are collected under the queue lock and their
+// callbacks run after it is released.
+//
+// Receives take messages past their queue's maxReceiveCount out of it, they
+// are pushed to the dead-letter queue after the source's lock is released,
+// so no two queue locks are ever held together. `redrive_mtx` guards the
+// index of dead-letter source queues and is taken after a queue lock, as is
+// `peers_mtx`.
+//
+// Message move tasks run on `scheduler` in chunks of MOVE_TASK_CHUNK
+// messages, each taken under one acquisition of the source lock and handed
+// to the destination like dead letters. Throttled tasks schedule their next
+// chunk once the rate allows it. `move_tasks_mtx` is never held together
+// with a queue lock.
+//
+// GetQueueAttributes and ListQueues take no queue lock. Every operation
+// changing a queue's messages publishes its counts before unlocking it, the
+// reaper also releases expired visibility timeouts and due delays, so that
+// counts of idle queues do not lag by more than REAP_INTERVAL.
+//
+// Striped queues spread their messages over partitions, each locked on its
+// own. Every thread cycles through the partitions for its sends and the
+// receives it starts. Receives drain the partitions in turn until they have
+// enough messages, leaving those of partitions with parked receives to them.
+// A waiting one parks on the last partition it tried and is only served from
+// there, so sends prefer partitions with waiters. Every partition has a body
+// pool of its own.
+// Deletes and visibility changes go to the partition named by the receipt
+// handle. Partition locks are taken after the striped queue's own.
+//
+// A sharded server runs one SQS per shard, each owning the queues shard_of
+// assigns to it, and routes every request to the owner of its queue. No
+// shard takes another's locks. Each keeps a replica of the names, URLs and
+// dead-letter sources of the other shards' queues, which their owners update
+// through its mailbox, and posts messages redriven or moved to a queue of
+// another shard to the owner's mailbox. ListQueues counts the messages of
+// other shards' queues from their published counters.
+//
+// Messages past their queue's MessageRetentionPeriod are expired on
+// `scheduler` every REAP_INTERVAL, at most REAP_SLICE per queue lock
+// acquisition. A pass that leaves expired messages behind runs again right
+// after the tasks already due. Queues only get locked by the reaper once
+// their published `reap_at` is due, so idle ones cost it an atomic load.
 class SQS {
  private:
-  boost::uuids::random_generator uuid_generator;
+  // A queue of any shard, `state` only set for those of this one.
+  struct NamedQueue {
+    std::string name;
+    std::string url;
+    bool fifo;
+    size_t shard;
+    std::shared_ptr<QueueState> state;
+  };
+  // The replica of a queue of another shard. Its state is only read for the
+  // published counters.
+  struct PeerQueue {
+    std::string url;
+    bool fifo;
+    std::shared_ptr<QueueState> state;
+  };
+  // Work collected under a queue lock and finished once it is released.
+  struct Completions {
+    std::vector<std::pair<ReceiveCallback, std::vector<Message>>> receives;
+    std::optional<NamedQueue> dead_letter_queue;
+    std::vector<MovedMessage> dead_letters;
+  };
+
   std::string endpoint;
-  std::map<std::string, std::deque<Message>> queues;
-  std::map<std::string, std::map<std::string, std::string>> queue_attrs;
-  std::map<std::string, std::map<std::string, std::string>> queue_tags;
+  std::atomic<std::shared_ptr<const QueueDirectory>> directory;
+  std::mutex directory_mtx;
+  std::mutex redrive_mtx;
+  // names of the queues of all shards redriving to each dead-letter queue,
+  // by its name
+  std::map<std::string, std::set<std::string>, std::less<>>
+      dead_letter_sources;
+  std::mutex peers_mtx;
+  // queues of the other shards by name
+  std::map<std::string, PeerQueue, std::less<>> peer_queues;
+  // all shards of a sharded server, this one included, empty when this one
+  // owns every queue
+  std::vector<Shard> shards;
+  size_t shard = 0;
+  std::mutex move_tasks_mtx;
+  // newest first, by source queue name
+  std::map<std::string, std::deque<std::shared_ptr<MoveTask>>, std::less<>>
+      move_tasks;
+  std::map<std::string, std::shared_ptr<MoveTask>> running_move_tasks;
+  Reclaimer reclaimer;
+  // declared last, its tasks use the members above
+  Scheduler scheduler;
 
+  Message new_message(QueueState& queue, std::string&& body);
+  SendParams send_params(QueueState& queue, const Message& msg,
+                         std::optional<long> delay_seconds,
+                         std::optional<std::string> group_id,
+                         std::optional<std::string> deduplication_id);
+  // Stores `msg`, or drops it as a duplicate of `sent` within the
+  // deduplication window of a FIFO queue. `sent` is the message the send is
+  // reported as either way.
+  SendMessageStatus enqueue(QueueState& queue, Message msg,
+                            const SendParams& params, DedupEntry& sent);
+  // takes messages from `queue` unless it has parked receives, which are
+  // served first
+  std::vector<Message> receive_from(const std::shared_ptr<QueueState>& queue,
+                                    int count,
+                                    std::optional<int> visibility_timeout);
+  ReceiveStatus receive_async_from(const std::shared_ptr<QueueState>& queue,
+                                   ReceiveMessageInput* input,
+                                   ReceiveCallback& callback);
+  std::vector<Message> receive_messages(QueueState& queue, int count,
+                                        long visibility_timeout,
+                                        Completions& done);
+  void serve_waiters(QueueState& queue, Completions& done);
+  void schedule_wake(const std::shared_ptr<QueueState>& queue);
+  void wake(const std::weak_ptr<QueueState>& weak_queue);
+  void complete(Completions& done);
+  void redrive(const std::shared_ptr<QueueState>& queue,
+               std::vector<MovedMessage> dead_letters);
+  // redrives here or posts the messages to the shard owning `queue`
+  void redrive(const NamedQueue& queue, std::vector<MovedMessage> dead_letters);
+  // runs `update` on every other shard, from its mailbox
+  void replicate(std::function<void(SQS&)> update);
+  // finds a queue of any shard by name
+  std::optional<NamedQueue> find_queue_by_name(std::string_view qname);
+  // names of the queues redriving to the queue, on all shards, in order
+  std::vector<std::string> dead_letter_source_names(std::string_view qname);
+  bool valid_redrive_policy(const QueueConfig& config,
+                            const std::string& qname);
+  void index_dead_letter_source(const std::string& qname,
+                                const std::optional<RedrivePolicy>& before,
+                                const std::optional<RedrivePolicy>& after);
+  std::string queue_arn(const std::string& qname);
+  void run_move_task(const std::shared_ptr<MoveTask>& task);
+  void reap();
+  void publish_attributes(QueueState& queue, long modified_at);
+  void finish_move_task(MoveTask& task, std::string status,
+                        std::string failure_reason);
   std::string new_queue_url(std::string qname);
-  std::string md5(std::string& data);
+  Digest md5(std::string_view data);
+  std::string sha256_hex(std::string_view data);
   long now();
-  std::mutex mtx;
+  boost::uuids::random_generator& uuid_generator();
 
  public:
   SQS(std::string ep);
-  std::string create_queue(CreateQueueInput* input);
+  // Makes this instance shard `index` of `all`, before any of them has a
+  // queue.
+  void join_shards(std::vector<Shard> all, size_t index);
+  std::optional<std::string> create_queue(CreateQueueInput* input);
   bool delete_queue(std::string qurl);
-  std::unique_ptr<std::vector<std::string>> get_queue_urls();
-  std::optional<std::string> get_queue_url(std::string qname);
+  // Lists queues in name order, those of all shards. NextToken is the name
+  // of the last queue returned, so pages stay consistent while queues come
+  // and go.
+  std::pair<ListQueuesStatus, std::unique_ptr<ListQueuesResponse>>
+  list_queues(ListQueuesInput* input);
+  std::optional<std::string> get_queue_url(std::string_view qname);
   bool tag_queue(std::string qurl, std::map<std::string, std::string>* tags);
   std::optional<std::unique_ptr<std::map<std::string, std::string>>>
   get_queue_tags(std::string qurl);
   bool untag_queue(std::string qurl, std::vector<std::string>* tag_keys);
-  std::unique_ptr<SendMessageResponse> send_message(SendMessageInput* input);
+  SetQueueAttributesStatus set_queue_attributes(SetQueueAttributesInput* input);
+  std::optional<std::unique_ptr<std::map<std::string, std::string>>>
+  get_queue_attributes(GetQueueAttributesInput* input);
+  std::pair<SendMessageStatus, std::unique_ptr<SendMessageResponse>>
+  send_message(SendMessageInput* input);
+  // Batches run all their entries under a single acquisition of the queue
+  // lock, ids and digests are computed before it is taken.
+  std::pair<BatchStatus, std::unique_ptr<SendMessageBatchResponse>>
+  send_message_batch(SendMessageBatchInput* input);
   int get_message_count(std::string& qurl);
   bool purge_queue(std::string qurl);
-  std::vector<Message> receive(std::string qurl, int count);
-  bool delete_message(DeleteMessageInput* input);
-  std::string get_queue_name(std::string& qurl);
-  std::unique_ptr<FullQueueDataResponse> get_queue_data(std::string qname);
+  // Expires messages whose retention period ended by `ts`, one slice per
+  // queue. Returns whether any queue may have more to expire.
+  bool expire_messages(long ts);
+  size_t pending_reclamation_bytes();
+  void drain_reclamation();
+  // Receives without waiting, regardless of WaitTimeSeconds. Nothing for
+  // parameters receive_async rejects.
+  std::vector<Message> receive(ReceiveMessageInput* input);
+  // Receives messages into `callback`. When none are visible and the receive
+  // waits, it is parked and ReceiveParked returned, the callback runs later
+  // on a sending or the scheduler thread. The callback is dropped uncalled
+  // for any other status but MessagesReceived.
+  ReceiveStatus receive_async(ReceiveMessageInput* input,
+                              ReceiveCallback callback);
+  DeleteMessageStatus delete_message(DeleteMessageInput* input);
+  ChangeMessageVisibilityStatus change_message_visibility(
+      ChangeMessageVisibilityInput* input);
+  std::pair<BatchStatus, std::unique_ptr<BatchResponse>> delete_message_batch(
+      DeleteMessageBatchInput* input);
+  std::pair<BatchStatus, std::unique_ptr<BatchResponse>>
+  change_message_visibility_batch(ChangeMessageVisibilityBatchInput* input);
+  // URLs of the queues whose RedrivePolicy targets the queue, in name order,
+  // nothing when it does not exist.
+  std::optional<std::vector<std::string>> list_dead_letter_source_queues(
+      std::string_view qurl);
+  // Moves the visible messages of a dead-letter queue to DestinationArn, or
+  // back to its source queue when it has only one, in the background.
+  std::pair<StartMoveTaskStatus, std::unique_ptr<StartMessageMoveTaskResponse>>
+  start_message_move_task(StartMessageMoveTaskInput* input);
+  // Nothing when no running task has the handle.
+  std::optional<std::unique_ptr<CancelMessageMoveTaskResponse>>
+  cancel_message_move_task(CancelMessageMoveTaskInput* input);
+  // Nothing when the source queue does not exist.
+  std::optional<std::unique_ptr<ListMessageMoveTasksResponse>>
+  list_message_move_tasks(ListMessageMoveTasksInput* input);
+  std::unique_ptr<FullQueueDataResponse> get_queue_data(std::string_view qname);
 };
 }  // namespace sqscpp
 
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "sqs.hpp"
+
+using namespace sqscpp;
+
+const int MESSAGES_PER_THREAD = 100000;
+const std::string BODY(64, 'x');
+
+// Messages per second sent and then deleted by `threads` producers sharing
+// one queue, either one message per call or MAX_BATCH_ENTRIES per call.
+double throughput(int threads, bool batch) {
+  SQS sqs("http://localhost:8080/000000000000");
+  auto create = CreateQueueInput("bench", {});
+  auto qurl = sqs.create_queue(&create).value();
+
+  auto produce = [&sqs, &qurl, batch]() {
+    int step = batch ? MAX_BATCH_ENTRIES : 1;
+    for (int i = 0; i < MESSAGES_PER_THREAD; i += step) {
+      if (batch) {
+        std::vector<SendMessageBatchEntry> entries;
+        for (size_t j = 0; j < MAX_BATCH_ENTRIES; j++) {
+          entries.push_back(
+              SendMessageBatchEntry{"m" + std::to_string(j), BODY, {}, {}});
+        }
+        auto input = SendMessageBatchInput(qurl, std::move(entries));
+        sqs.send_message_batch(&input);
+      } else {
+        auto input = SendMessageInput(qurl, BODY, {}, {});
+        sqs.send_message(&input);
+      }
+    }
+  };
+
+  auto consume = [&sqs, &qurl, batch]() {
+    for (int i = 0; i < MESSAGES_PER_THREAD; i += MAX_BATCH_ENTRIES) {
+      auto receive =
+          ReceiveMessageInput(qurl, MAX_BATCH_ENTRIES, {}, 3600, {});
+      auto msgs = sqs.receive(&receive);
+      if (batch) {
+        std::vector<DeleteMessageBatchEntry> entries;
+        for (size_t j = 0; j < msgs.size(); j++) {
+          entries.push_back(DeleteMessageBatchEntry{
+              "m" + std::to_string(j), format_uuid(msgs[j].receipt_handle)});
+        }
+        auto input = DeleteMessageBatchInput(qurl, std::move(entries));
+        sqs.delete_message_batch(&input);
+      } else {
+        for (auto& msg : msgs) {
+          auto receipt_handle = format_uuid(msg.receipt_handle);
+          auto input = DeleteMessageInput(qurl, receipt_handle);
+          sqs.delete_message(&input);
+        }
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::function<void()>> phases = {produce, consume};
+  for (auto& phase : phases) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back(phase);
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return threads * MESSAGES_PER_THREAD /
+         std::chrono::duration<double>(elapsed).count();
+}
+
+auto main() -> int {
+  std::cout << "threads\tsingle msg/s\tbatch msg/s" << std::endl;
+  for (int threads : {1, 2, 4, 8}) {
+    std::cout << threads << "\t" << (long)throughput(threads, false) << "\t\t"
+              << (long)throughput(threads, true) << std::endl;
+  }
+  return 0;
+}
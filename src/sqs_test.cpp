@@ -0,0 +1,1058 @@
+#include "sqs.hpp"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <set>
+#include <thread>
+
+using namespace sqscpp;
+
+const std::string ENDPOINT = "http://localhost:8080/000000000000";
+
+std::string create_queue(SQS* sqs, std::string qname,
+                         std::map<std::string, std::string> attrs = {}) {
+  auto input = CreateQueueInput(qname, attrs);
+  return sqs->create_queue(&input).value();
+}
+
+std::unique_ptr<SendMessageResponse> send_message(SQS* sqs, std::string qurl,
+                                                  std::string body) {
+  auto input = SendMessageInput(qurl, body, {}, {});
+  return sqs->send_message(&input).second;
+}
+
+std::vector<QueueInfo> list_queues(SQS* sqs, bool message_counts = false) {
+  auto input = ListQueuesInput({}, {}, {}, message_counts);
+  return sqs->list_queues(&input).second->queues;
+}
+
+std::vector<Message> receive(SQS* sqs, std::string qurl, int count,
+                             std::optional<int> visibility_timeout = {}) {
+  auto input = ReceiveMessageInput(qurl, count, {}, visibility_timeout, {});
+  return sqs->receive(&input);
+}
+
+// Starts a receive that waits up to `wait_time` seconds, the future resolves
+// with the messages once it completes.
+std::future<std::vector<Message>> receive_async(SQS* sqs, std::string qurl,
+                                                long wait_time,
+                                                ReceiveStatus* status) {
+  auto done = std::make_shared<std::promise<std::vector<Message>>>();
+  auto input = ReceiveMessageInput(qurl, 1, {}, {}, wait_time);
+  *status = sqs->receive_async(&input, [done](std::vector<Message> msgs) {
+    done->set_value(std::move(msgs));
+  });
+  return done->get_future();
+}
+
+bool is_ready(std::future<std::vector<Message>>& f) {
+  return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+TEST(sqs_test, send_receive_delete) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  auto sent = send_message(&sqs, qurl, "hello");
+
+  auto msgs = receive(&sqs, qurl, 10);
+  EXPECT_EQ(msgs.size(), 1);
+  EXPECT_EQ(format_uuid(msgs[0].message_id), sent->message_id);
+  EXPECT_EQ(format_digest(msgs[0].md5_of_body),
+            "5d41402abc4b2a76b9719d911017c592");
+  EXPECT_EQ(msgs[0].body.view(), "hello");
+
+  auto receipt_handle = format_uuid(msgs[0].receipt_handle);
+  auto input = DeleteMessageInput(qurl, receipt_handle);
+  EXPECT_EQ(sqs.delete_message(&input), MessageDeleted);
+  EXPECT_EQ(sqs.delete_message(&input), ReceiptHandleInvalid);
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+}
+
+TEST(sqs_test, create_existing_queue_keeps_messages) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+
+  EXPECT_EQ(create_queue(&sqs, "test-queue"), qurl);
+  EXPECT_EQ(sqs.get_message_count(qurl), 1);
+}
+
+TEST(sqs_test, concurrent_send_to_independent_queues) {
+  SQS sqs(ENDPOINT);
+  std::vector<std::string> qurls;
+  for (int i = 0; i < 4; i++) {
+    qurls.push_back(create_queue(&sqs, "test-queue-" + std::to_string(i)));
+  }
+
+  std::vector<std::thread> threads;
+  for (const auto& qurl : qurls) {
+    threads.emplace_back([&sqs, qurl]() {
+      for (int i = 0; i < 1000; i++) {
+        send_message(&sqs, qurl, "hello");
+        std::map<std::string, std::string> tags = {{"key", "value"}};
+        sqs.tag_queue(qurl, &tags);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (auto& qurl : qurls) {
+    EXPECT_EQ(sqs.get_message_count(qurl), 1000);
+    EXPECT_EQ(sqs.get_queue_tags(qurl).value()->at("key"), "value");
+  }
+}
+
+TEST(sqs_test, queue_directory_follows_create_and_delete) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  create_queue(&sqs, "other-queue");
+  send_message(&sqs, qurl, "hello");
+
+  EXPECT_EQ(sqs.get_queue_url("test-queue").value(), qurl);
+  auto queues = list_queues(&sqs, true);
+  EXPECT_EQ(queues.size(), 2);
+  EXPECT_EQ(queues[1].queue_name, "test-queue");
+  EXPECT_EQ(queues[1].message_count, 1);
+
+  EXPECT_TRUE(sqs.delete_queue(qurl));
+  EXPECT_FALSE(sqs.get_queue_url("test-queue").has_value());
+  EXPECT_EQ(list_queues(&sqs).size(), 1);
+  EXPECT_EQ(send_message(&sqs, qurl, "hello"), nullptr);
+}
+
+TEST(sqs_test, list_queues_pages_through_prefix) {
+  SQS sqs(ENDPOINT);
+  for (auto qname : {"a-1", "b-1", "b-2", "b-3", "c-1"}) {
+    create_queue(&sqs, qname);
+  }
+
+  auto input = ListQueuesInput("b-", 2, {});
+  auto [status, page] = sqs.list_queues(&input);
+  EXPECT_EQ(status, QueuesListed);
+  ASSERT_EQ(page->queues.size(), 2);
+  EXPECT_EQ(page->queues[0].queue_name, "b-1");
+  EXPECT_FALSE(page->queues[0].message_count.has_value());
+  EXPECT_EQ(page->next_token, "b-2");
+
+  // the cursor survives the deletion of the queue it points at
+  EXPECT_TRUE(sqs.delete_queue(page->queues[1].queue_url));
+  input = ListQueuesInput("b-", 2, page->next_token);
+  page = sqs.list_queues(&input).second;
+  ASSERT_EQ(page->queues.size(), 1);
+  EXPECT_EQ(page->queues[0].queue_name, "b-3");
+  EXPECT_FALSE(page->next_token.has_value());
+
+  input = ListQueuesInput({}, 1001, {});
+  EXPECT_EQ(sqs.list_queues(&input).first, MaxResultsInvalid);
+  input = ListQueuesInput({}, std::numeric_limits<int>::max(), {});
+  EXPECT_EQ(sqs.list_queues(&input).first, MaxResultsInvalid);
+  input = ListQueuesInput("d-", {}, {});
+  EXPECT_TRUE(sqs.list_queues(&input).second->queues.empty());
+}
+
+TEST(sqs_test, recreated_queue_starts_empty) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+  std::map<std::string, std::string> tags = {{"key", "value"}};
+  sqs.tag_queue(qurl, &tags);
+
+  EXPECT_TRUE(sqs.delete_queue(qurl));
+  EXPECT_EQ(create_queue(&sqs, "test-queue"), qurl);
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+  EXPECT_TRUE(sqs.get_queue_tags(qurl).value()->empty());
+}
+
+TEST(sqs_test, create_queue_rejects_invalid_attribute) {
+  SQS sqs(ENDPOINT);
+  auto input = CreateQueueInput("test-queue", {{{"VisibilityTimeout", "-1"}}});
+
+  EXPECT_FALSE(sqs.create_queue(&input).has_value());
+  EXPECT_FALSE(sqs.get_queue_url("test-queue").has_value());
+}
+
+TEST(sqs_test, set_and_get_queue_attributes) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"VisibilityTimeout", "10"}});
+
+  auto set = SetQueueAttributesInput(qurl, {{"MaximumMessageSize", "2048"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+  auto invalid = SetQueueAttributesInput(qurl, {{"DelaySeconds", "ten"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&invalid), AttributeValueInvalid);
+
+  auto get = GetQueueAttributesInput(
+      qurl, std::vector<std::string>{"VisibilityTimeout", "MaximumMessageSize",
+                                     "DelaySeconds"});
+  auto attrs = sqs.get_queue_attributes(&get).value();
+  EXPECT_EQ(attrs->size(), 3);
+  EXPECT_EQ(attrs->at("VisibilityTimeout"), "10");
+  EXPECT_EQ(attrs->at("MaximumMessageSize"), "2048");
+  EXPECT_EQ(attrs->at("DelaySeconds"), "0");
+
+  auto input = SendMessageInput(qurl, std::string(2049, 'x'), {}, {});
+  EXPECT_EQ(sqs.send_message(&input).first, MessageTooLong);
+}
+
+TEST(sqs_test, receive_honors_visibility_timeout) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"VisibilityTimeout", "0"}});
+  send_message(&sqs, qurl, "hello");
+
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+  EXPECT_EQ(receive(&sqs, qurl, 1, 60).size(), 1);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 0);
+}
+
+TEST(sqs_test, purge_reclaims_messages_in_background) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  for (int i = 0; i < 1000; i++) {
+    send_message(&sqs, qurl, "hello");
+  }
+
+  EXPECT_TRUE(sqs.purge_queue(qurl));
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+  send_message(&sqs, qurl, "hello");
+  EXPECT_EQ(receive(&sqs, qurl, 10).size(), 1);
+
+  sqs.drain_reclamation();
+  EXPECT_EQ(sqs.pending_reclamation_bytes(), 0);
+}
+
+TEST(sqs_test, expire_messages_honors_retention_period) {
+  SQS sqs(ENDPOINT);
+  auto short_lived =
+      create_queue(&sqs, "short-lived", {{"MessageRetentionPeriod", "60"}});
+  auto qurl = create_queue(&sqs, "test-queue");
+  for (size_t i = 0; i < REAP_SLICE + 10; i++) {
+    send_message(&sqs, short_lived, "hello");
+  }
+  send_message(&sqs, qurl, "hello");
+
+  // a full slice leaves the rest for the next pass
+  auto ts = std::time(nullptr) + 61;
+  EXPECT_TRUE(sqs.expire_messages(ts));
+  EXPECT_EQ(sqs.get_message_count(short_lived), 10);
+  EXPECT_FALSE(sqs.expire_messages(ts));
+  EXPECT_EQ(sqs.get_message_count(short_lived), 0);
+  EXPECT_EQ(sqs.get_message_count(qurl), 1);
+}
+
+TEST(sqs_test, expire_messages_follows_retention_changes) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+  auto ts = std::time(nullptr) + 61;
+  EXPECT_FALSE(sqs.expire_messages(ts));
+  EXPECT_EQ(sqs.get_message_count(qurl), 1);
+
+  auto set = SetQueueAttributesInput(qurl, {{"MessageRetentionPeriod", "60"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+  EXPECT_FALSE(sqs.expire_messages(ts));
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+
+  // an expiring visibility timeout is due for the reaper too
+  send_message(&sqs, qurl, "hello");
+  receive(&sqs, qurl, 1, 1);
+  EXPECT_FALSE(sqs.expire_messages(std::time(nullptr) + 2));
+  auto attrs_input = GetQueueAttributesInput(qurl, {});
+  auto attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessages"), "1");
+}
+
+TEST(sqs_test, long_poll_returns_visible_messages_at_once) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, MessagesReceived);
+  ASSERT_TRUE(is_ready(msgs));
+  EXPECT_EQ(msgs.get().size(), 1);
+}
+
+TEST(sqs_test, long_poll_completes_on_send) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, ReceiveParked);
+  EXPECT_FALSE(is_ready(msgs));
+
+  send_message(&sqs, qurl, "hello");
+  ASSERT_TRUE(is_ready(msgs));
+  auto received = msgs.get();
+  ASSERT_EQ(received.size(), 1);
+  EXPECT_EQ(received[0].body.view(), "hello");
+}
+
+TEST(sqs_test, long_poll_serves_waiters_oldest_first) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+
+  ReceiveStatus status;
+  auto first = receive_async(&sqs, qurl, 20, &status);
+  auto second = receive_async(&sqs, qurl, 20, &status);
+
+  send_message(&sqs, qurl, "one");
+  ASSERT_TRUE(is_ready(first));
+  EXPECT_FALSE(is_ready(second));
+  EXPECT_EQ(first.get()[0].body.view(), "one");
+
+  send_message(&sqs, qurl, "two");
+  ASSERT_TRUE(is_ready(second));
+  EXPECT_EQ(second.get()[0].body.view(), "two");
+}
+
+TEST(sqs_test, long_poll_wakes_when_visibility_expires) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+  EXPECT_EQ(receive(&sqs, qurl, 1, 1).size(), 1);
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, ReceiveParked);
+  ASSERT_EQ(msgs.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  EXPECT_EQ(msgs.get().size(), 1);
+}
+
+TEST(sqs_test, long_poll_expires_empty) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 1, &status);
+  EXPECT_EQ(status, ReceiveParked);
+  ASSERT_EQ(msgs.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  EXPECT_EQ(msgs.get().size(), 0);
+}
+
+TEST(sqs_test, long_poll_uses_queue_wait_time) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue",
+                           {{"ReceiveMessageWaitTimeSeconds", "5"}});
+
+  bool called = false;
+  auto input = ReceiveMessageInput(qurl, 1, {}, {}, {});
+  auto status = sqs.receive_async(
+      &input, [&called](std::vector<Message>) { called = true; });
+  EXPECT_EQ(status, ReceiveParked);
+  EXPECT_FALSE(called);
+
+  send_message(&sqs, qurl, "hello");
+  EXPECT_TRUE(called);
+}
+
+TEST(sqs_test, long_poll_caps_waiters_per_queue) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+
+  ReceiveStatus status;
+  std::vector<std::future<std::vector<Message>>> parked;
+  for (size_t i = 0; i < MAX_WAITERS_PER_QUEUE; i++) {
+    parked.push_back(receive_async(&sqs, qurl, 20, &status));
+    ASSERT_EQ(status, ReceiveParked);
+  }
+  receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, TooManyWaiters);
+
+  EXPECT_TRUE(sqs.delete_queue(qurl));
+  for (auto& msgs : parked) {
+    ASSERT_TRUE(is_ready(msgs));
+    EXPECT_EQ(msgs.get().size(), 0);
+  }
+}
+
+TEST(sqs_test, long_poll_rejects_invalid_parameters) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+
+  auto called = false;
+  auto callback = [&called](std::vector<Message>) { called = true; };
+  for (int count : {0, 11, -1}) {
+    auto input = ReceiveMessageInput(qurl, count, {}, {}, 20);
+    EXPECT_EQ(sqs.receive_async(&input, callback), MaxNumberOfMessagesInvalid);
+    EXPECT_EQ(receive(&sqs, qurl, count).size(), 0);
+  }
+  for (long wait_time : {-1, 21}) {
+    auto input = ReceiveMessageInput(qurl, 1, {}, {}, wait_time);
+    EXPECT_EQ(sqs.receive_async(&input, callback), WaitTimeSecondsInvalid);
+  }
+  for (int visibility_timeout : {-1, 43201}) {
+    auto input = ReceiveMessageInput(qurl, 1, {}, visibility_timeout, 20);
+    EXPECT_EQ(sqs.receive_async(&input, callback),
+              ReceiveVisibilityTimeoutInvalid);
+  }
+  EXPECT_FALSE(called);
+
+  // nothing was parked or received, the next long poll gets the message
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, MessagesReceived);
+  ASSERT_TRUE(is_ready(msgs));
+  EXPECT_EQ(msgs.get().size(), 1);
+}
+
+TEST(sqs_test, delayed_message_is_counted_until_due) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  auto input = SendMessageInput(qurl, "hello", 60, {});
+  EXPECT_EQ(sqs.send_message(&input).first, MessageSent);
+
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 0);
+  auto attrs_input = GetQueueAttributesInput(qurl, {});
+  auto attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessages"), "0");
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessagesNotVisible"), "0");
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessagesDelayed"), "1");
+}
+
+TEST(sqs_test, queue_attributes_follow_message_changes) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  auto attrs_input = GetQueueAttributesInput(qurl, {});
+  auto created = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(created->at("ApproximateNumberOfMessages"), "0");
+  EXPECT_EQ(created->at("ApproximateAgeOfOldestMessage"), "0");
+  EXPECT_EQ(created->at("LastModifiedTimestamp"),
+            created->at("CreatedTimestamp"));
+
+  send_message(&sqs, qurl, "a");
+  send_message(&sqs, qurl, "b");
+  auto msgs = receive(&sqs, qurl, 1);
+  auto attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessages"), "1");
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessagesNotVisible"), "1");
+
+  auto receipt_handle = format_uuid(msgs[0].receipt_handle);
+  auto input = DeleteMessageInput(qurl, receipt_handle);
+  EXPECT_EQ(sqs.delete_message(&input), MessageDeleted);
+  attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessages"), "1");
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessagesNotVisible"), "0");
+  EXPECT_EQ(list_queues(&sqs, true)[0].message_count, 1);
+
+  EXPECT_TRUE(sqs.purge_queue(qurl));
+  attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessages"), "0");
+}
+
+TEST(sqs_test, queue_delay_applies_without_message_delay) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"DelaySeconds", "1"}});
+  send_message(&sqs, qurl, "hello");
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 0);
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, ReceiveParked);
+  ASSERT_EQ(msgs.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  EXPECT_EQ(msgs.get().size(), 1);
+}
+
+TEST(sqs_test, message_delay_overrides_queue_delay) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"DelaySeconds", "60"}});
+  auto input = SendMessageInput(qurl, "hello", 0, {});
+  sqs.send_message(&input);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+
+  input = SendMessageInput(qurl, "hello", 901, {});
+  EXPECT_EQ(sqs.send_message(&input).first, DelaySecondsInvalid);
+}
+
+TEST(sqs_test, send_message_batch_reports_each_entry) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  auto input = SendMessageBatchInput(
+      qurl, {SendMessageBatchEntry{"a", "one", {}, {}},
+             SendMessageBatchEntry{"b", "two", 901, {}},
+             SendMessageBatchEntry{"c", "three", {}, {}}});
+  auto [status, res] = sqs.send_message_batch(&input);
+
+  ASSERT_EQ(status, BatchExecuted);
+  ASSERT_EQ(res->successful.size(), 2);
+  EXPECT_EQ(res->successful[0].id, "a");
+  EXPECT_EQ(res->successful[1].id, "c");
+  EXPECT_EQ(res->successful[0].md5_of_message_body,
+            "f97c5d29941bfb1b2fdab0874906ab82");
+  ASSERT_EQ(res->failed.size(), 1);
+  EXPECT_EQ(res->failed[0].id, "b");
+  EXPECT_EQ(sqs.get_message_count(qurl), 2);
+}
+
+TEST(sqs_test, send_message_batch_rejects_bad_batches) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+
+  auto input = SendMessageBatchInput(qurl, {});
+  EXPECT_EQ(sqs.send_message_batch(&input).first, BatchEmpty);
+
+  input = SendMessageBatchInput(qurl,
+                                {SendMessageBatchEntry{"a", "1", {}, {}},
+                                 SendMessageBatchEntry{"a", "2", {}, {}}});
+  EXPECT_EQ(sqs.send_message_batch(&input).first, BatchIdsNotDistinct);
+
+  input =
+      SendMessageBatchInput(qurl, {SendMessageBatchEntry{"a.b", "1", {}, {}}});
+  EXPECT_EQ(sqs.send_message_batch(&input).first, BatchEntryIdInvalid);
+
+  std::vector<SendMessageBatchEntry> entries;
+  for (size_t i = 0; i <= MAX_BATCH_ENTRIES; i++) {
+    entries.push_back(SendMessageBatchEntry{std::to_string(i), "1", {}, {}});
+  }
+  input = SendMessageBatchInput(qurl, entries);
+  EXPECT_EQ(sqs.send_message_batch(&input).first, BatchTooManyEntries);
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+}
+
+TEST(sqs_test, delete_message_batch_reports_each_entry) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "one");
+  send_message(&sqs, qurl, "two");
+  auto msgs = receive(&sqs, qurl, 10);
+
+  auto input = DeleteMessageBatchInput(
+      qurl,
+      {DeleteMessageBatchEntry{"a", format_uuid(msgs[0].receipt_handle)},
+       DeleteMessageBatchEntry{"b", "bogus"},
+       DeleteMessageBatchEntry{"c", format_uuid(msgs[1].receipt_handle)}});
+  auto [status, res] = sqs.delete_message_batch(&input);
+
+  ASSERT_EQ(status, BatchExecuted);
+  EXPECT_EQ(res->successful, (std::vector<std::string>{"a", "c"}));
+  ASSERT_EQ(res->failed.size(), 1);
+  EXPECT_EQ(res->failed[0].code, "ReceiptHandleIsInvalid");
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+}
+
+TEST(sqs_test, change_message_visibility_batch_releases_to_waiters) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue");
+  send_message(&sqs, qurl, "hello");
+  auto msgs = receive(&sqs, qurl, 1);
+
+  ReceiveStatus status;
+  auto parked = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, ReceiveParked);
+
+  auto input = ChangeMessageVisibilityBatchInput(
+      qurl, {ChangeMessageVisibilityBatchEntry{
+                 "a", format_uuid(msgs[0].receipt_handle), 0},
+             ChangeMessageVisibilityBatchEntry{"b", "bogus", 0},
+             ChangeMessageVisibilityBatchEntry{
+                 "c", format_uuid(msgs[0].receipt_handle), 43201}});
+  auto [batch_status, res] = sqs.change_message_visibility_batch(&input);
+
+  ASSERT_EQ(batch_status, BatchExecuted);
+  EXPECT_EQ(res->successful, std::vector<std::string>{"a"});
+  EXPECT_EQ(res->failed.size(), 2);
+  ASSERT_TRUE(is_ready(parked));
+  EXPECT_EQ(parked.get().size(), 1);
+}
+
+TEST(sqs_test, change_message_visibility_extends_lease) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"VisibilityTimeout", "0"}});
+  send_message(&sqs, qurl, "hello");
+  auto msgs = receive(&sqs, qurl, 1, 1);
+  auto receipt_handle = format_uuid(msgs[0].receipt_handle);
+
+  auto input = ChangeMessageVisibilityInput(qurl, receipt_handle, 600);
+  EXPECT_EQ(sqs.change_message_visibility(&input), VisibilityChanged);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 0);
+
+  input = ChangeMessageVisibilityInput(qurl, receipt_handle, 43201);
+  EXPECT_EQ(sqs.change_message_visibility(&input), VisibilityTimeoutInvalid);
+  input = ChangeMessageVisibilityInput(qurl, "bogus", 0);
+  EXPECT_EQ(sqs.change_message_visibility(&input),
+            VisibilityReceiptHandleInvalid);
+
+  input = ChangeMessageVisibilityInput(qurl, receipt_handle, 0);
+  EXPECT_EQ(sqs.change_message_visibility(&input), VisibilityChanged);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+}
+
+TEST(sqs_test, striped_queue_spreads_messages_over_partitions) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"Partitions", "4"}});
+  for (int i = 0; i < 8; i++) {
+    send_message(&sqs, qurl, "hello");
+  }
+  EXPECT_EQ(sqs.get_message_count(qurl), 8);
+  auto queues = list_queues(&sqs, true);
+  ASSERT_EQ(queues.size(), 1);
+  EXPECT_EQ(queues[0].message_count, 8);
+
+  auto msgs = receive(&sqs, qurl, 10);
+  ASSERT_EQ(msgs.size(), 8);
+  std::set<uint8_t> tags;
+  for (const auto& msg : msgs) {
+    tags.insert(msg.receipt_handle.data[0]);
+  }
+  EXPECT_GT(tags.size(), 1);
+  auto attrs_input = GetQueueAttributesInput(qurl, {});
+  auto attrs = sqs.get_queue_attributes(&attrs_input).value();
+  EXPECT_EQ(attrs->at("ApproximateNumberOfMessagesNotVisible"), "8");
+  EXPECT_EQ(attrs->at("Partitions"), "4");
+
+  auto change = ChangeMessageVisibilityInput(
+      qurl, format_uuid(msgs[0].receipt_handle), 0);
+  EXPECT_EQ(sqs.change_message_visibility(&change), VisibilityChanged);
+  auto released = receive(&sqs, qurl, 10);
+  ASSERT_EQ(released.size(), 1);
+  msgs[0] = released[0];
+
+  std::vector<DeleteMessageBatchEntry> entries;
+  for (size_t i = 1; i < msgs.size(); i++) {
+    entries.push_back(DeleteMessageBatchEntry{
+        std::to_string(i), format_uuid(msgs[i].receipt_handle)});
+  }
+  entries.push_back(DeleteMessageBatchEntry{"bogus", "bogus"});
+  auto batch = DeleteMessageBatchInput(qurl, entries);
+  auto [status, res] = sqs.delete_message_batch(&batch);
+  ASSERT_EQ(status, BatchExecuted);
+  EXPECT_EQ(res->successful.size(), 7);
+  ASSERT_EQ(res->failed.size(), 1);
+  EXPECT_EQ(res->failed[0].id, "bogus");
+
+  auto receipt_handle = format_uuid(msgs[0].receipt_handle);
+  auto input = DeleteMessageInput(qurl, receipt_handle);
+  EXPECT_EQ(sqs.delete_message(&input), MessageDeleted);
+  EXPECT_EQ(sqs.delete_message(&input), ReceiptHandleInvalid);
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+}
+
+TEST(sqs_test, striped_queue_partitions_are_fixed) {
+  SQS sqs(ENDPOINT);
+  auto fifo = CreateQueueInput("test-queue.fifo",
+                               {{{"FifoQueue", "true"}, {"Partitions", "4"}}});
+  EXPECT_FALSE(sqs.create_queue(&fifo).has_value());
+
+  auto qurl = create_queue(&sqs, "test-queue", {{"Partitions", "4"}});
+  auto set = SetQueueAttributesInput(qurl, {{"Partitions", "8"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributeValueInvalid);
+  set = SetQueueAttributesInput(qurl, {{"VisibilityTimeout", "0"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+
+  // the partitions follow the queue's config
+  send_message(&sqs, qurl, "hello");
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+}
+
+TEST(sqs_test, striped_queue_partitions_have_own_body_pools) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"Partitions", "4"}});
+  for (int i = 0; i < 8; i++) {
+    send_message(&sqs, qurl, "hello");
+  }
+
+  // the queue reports the blocks of all its partitions
+  auto data = sqs.get_queue_data("test-queue");
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(data->messages.size(), 8);
+  EXPECT_EQ(data->body_pool_stats.blocks_in_use, 8);
+  EXPECT_GT(data->body_pool_stats.bytes_reserved, 0);
+  auto msgs = receive(&sqs, qurl, 10);
+  ASSERT_EQ(msgs.size(), 8);
+  for (const auto& msg : msgs) {
+    auto receipt_handle = format_uuid(msg.receipt_handle);
+    auto input = DeleteMessageInput(qurl, receipt_handle);
+    EXPECT_EQ(sqs.delete_message(&input), MessageDeleted);
+  }
+  // the bodies are shared with the messages read so far
+  msgs.clear();
+  data.reset();
+  sqs.drain_reclamation();
+  data = sqs.get_queue_data("test-queue");
+  EXPECT_EQ(data->body_pool_stats.blocks_in_use, 0);
+}
+
+TEST(sqs_test, striped_queue_long_poll_completes_on_send) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue", {{"Partitions", "4"}});
+
+  ReceiveStatus status;
+  auto msgs = receive_async(&sqs, qurl, 20, &status);
+  EXPECT_EQ(status, ReceiveParked);
+
+  send_message(&sqs, qurl, "hello");
+  ASSERT_TRUE(is_ready(msgs));
+  EXPECT_EQ(msgs.get().size(), 1);
+  EXPECT_TRUE(sqs.delete_queue(qurl));
+}
+
+TEST(sqs_test, fifo_queue_requires_fifo_name) {
+  SQS sqs(ENDPOINT);
+  auto standard = CreateQueueInput("test-queue", {{{"FifoQueue", "true"}}});
+  EXPECT_FALSE(sqs.create_queue(&standard).has_value());
+  auto fifo = CreateQueueInput("test-queue.fifo", {});
+  EXPECT_FALSE(sqs.create_queue(&fifo).has_value());
+
+  auto qurl = create_queue(&sqs, "test-queue.fifo", {{"FifoQueue", "true"}});
+  auto set = SetQueueAttributesInput(qurl, {{"FifoQueue", "false"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributeValueInvalid);
+  set = SetQueueAttributesInput(qurl, {{"ContentBasedDeduplication", "true"}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+}
+
+TEST(sqs_test, fifo_send_drops_duplicates) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue.fifo", {{"FifoQueue", "true"}});
+
+  auto input = SendMessageInput(qurl, "one", {}, "d1", "g");
+  auto [status, first] = sqs.send_message(&input);
+  EXPECT_EQ(status, MessageSent);
+  input = SendMessageInput(qurl, "two", {}, "d1", "g");
+  auto [dup_status, dup] = sqs.send_message(&input);
+  EXPECT_EQ(dup_status, MessageSent);
+  EXPECT_EQ(dup->message_id, first->message_id);
+  EXPECT_EQ(dup->md5_of_message_body, first->md5_of_message_body);
+  EXPECT_EQ(sqs.get_message_count(qurl), 1);
+
+  input = SendMessageInput(qurl, "three", {}, {}, "g");
+  EXPECT_EQ(sqs.send_message(&input).first, DeduplicationIdMissing);
+  input = SendMessageInput(qurl, "three", {}, "d3", {});
+  EXPECT_EQ(sqs.send_message(&input).first, MessageGroupIdMissing);
+  input = SendMessageInput(qurl, "three", 5, "d3", "g");
+  EXPECT_EQ(sqs.send_message(&input).first, DelaySecondsInvalid);
+}
+
+TEST(sqs_test, fifo_send_deduplicates_by_content) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(
+      &sqs, "test-queue.fifo",
+      {{"FifoQueue", "true"}, {"ContentBasedDeduplication", "true"}});
+
+  auto batch = SendMessageBatchInput(
+      qurl, {SendMessageBatchEntry{"a", "same", {}, {}, "g"},
+             SendMessageBatchEntry{"b", "same", {}, {}, "g"},
+             SendMessageBatchEntry{"c", "other", {}, {}, "g"},
+             SendMessageBatchEntry{"d", "other", {}, {}, {}}});
+  auto [status, res] = sqs.send_message_batch(&batch);
+  EXPECT_EQ(status, BatchExecuted);
+  ASSERT_EQ(res->successful.size(), 3);
+  EXPECT_EQ(res->successful[1].message_id, res->successful[0].message_id);
+  ASSERT_EQ(res->failed.size(), 1);
+  EXPECT_EQ(res->failed[0].id, "d");
+  EXPECT_EQ(sqs.get_message_count(qurl), 2);
+}
+
+TEST(sqs_test, fifo_delete_unlocks_group_for_waiters) {
+  SQS sqs(ENDPOINT);
+  auto qurl = create_queue(&sqs, "test-queue.fifo",
+                           {{"FifoQueue", "true"},
+                            {"ContentBasedDeduplication", "true"}});
+  for (auto body : {"one", "two"}) {
+    auto input = SendMessageInput(qurl, body, {}, {}, "g");
+    sqs.send_message(&input);
+  }
+  auto msgs = receive(&sqs, qurl, 1);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "one");
+
+  ReceiveStatus status;
+  auto waiting = receive_async(&sqs, qurl, 5, &status);
+  EXPECT_EQ(status, ReceiveParked);
+  auto receipt_handle = format_uuid(msgs[0].receipt_handle);
+  auto input = DeleteMessageInput(qurl, receipt_handle);
+  EXPECT_EQ(sqs.delete_message(&input), MessageDeleted);
+  ASSERT_TRUE(is_ready(waiting));
+  auto next = waiting.get();
+  ASSERT_EQ(next.size(), 1);
+  EXPECT_EQ(next[0].body.view(), "two");
+}
+
+std::string redrive_policy(std::string dlq, int max_receive_count) {
+  return R"({"deadLetterTargetArn":"arn:aws:sqs:us-east-1:000000000000:)" +
+         dlq + R"(","maxReceiveCount":)" + std::to_string(max_receive_count) +
+         "}";
+}
+
+TEST(sqs_test, redrive_moves_message_to_dead_letter_queue) {
+  SQS sqs(ENDPOINT);
+  auto dlq = create_queue(&sqs, "dlq");
+  auto qurl = create_queue(&sqs, "test-queue",
+                           {{"RedrivePolicy", redrive_policy("dlq", 2)},
+                            {"VisibilityTimeout", "0"}});
+  auto sent = send_message(&sqs, qurl, "poison");
+
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 1);
+  auto msgs = receive(&sqs, qurl, 1);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].receive_count, 2);
+  EXPECT_EQ(receive(&sqs, qurl, 1).size(), 0);
+  EXPECT_EQ(sqs.get_message_count(qurl), 0);
+
+  auto dead = receive(&sqs, dlq, 1);
+  ASSERT_EQ(dead.size(), 1);
+  EXPECT_EQ(format_uuid(dead[0].message_id), sent->message_id);
+  EXPECT_EQ(dead[0].body.view(), "poison");
+  EXPECT_EQ(dead[0].receive_count, 3);
+}
+
+TEST(sqs_test, redrive_policy_requires_dead_letter_queue) {
+  SQS sqs(ENDPOINT);
+  auto missing = CreateQueueInput(
+      "test-queue", {{{"RedrivePolicy", redrive_policy("dlq", 2)}}});
+  EXPECT_FALSE(sqs.create_queue(&missing).has_value());
+
+  create_queue(&sqs, "dlq.fifo", {{"FifoQueue", "true"}});
+  auto mismatched = CreateQueueInput(
+      "test-queue", {{{"RedrivePolicy", redrive_policy("dlq.fifo", 2)}}});
+  EXPECT_FALSE(sqs.create_queue(&mismatched).has_value());
+}
+
+TEST(sqs_test, list_dead_letter_source_queues_follows_policies) {
+  SQS sqs(ENDPOINT);
+  auto dlq = create_queue(&sqs, "dlq");
+  auto a =
+      create_queue(&sqs, "a", {{"RedrivePolicy", redrive_policy("dlq", 5)}});
+  auto b = create_queue(&sqs, "b");
+  auto set = SetQueueAttributesInput(
+      b, {{"RedrivePolicy", redrive_policy("dlq", 5)}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+  EXPECT_EQ(sqs.list_dead_letter_source_queues(dlq).value(),
+            (std::vector<std::string>{a, b}));
+
+  set = SetQueueAttributesInput(a, {{"RedrivePolicy", ""}});
+  EXPECT_EQ(sqs.set_queue_attributes(&set), AttributesSet);
+  sqs.delete_queue(b);
+  EXPECT_TRUE(sqs.list_dead_letter_source_queues(dlq).value().empty());
+  EXPECT_FALSE(sqs.list_dead_letter_source_queues("missing").has_value());
+}
+
+TEST(sqs_test, set_attributes_racing_delete_leaves_no_source_behind) {
+  SQS sqs(ENDPOINT);
+  create_queue(&sqs, "dlq");
+  auto other = create_queue(&sqs, "other-dlq");
+  for (int i = 0; i < 200; i++) {
+    auto a =
+        create_queue(&sqs, "a", {{"RedrivePolicy", redrive_policy("dlq", 5)}});
+    auto set = SetQueueAttributesInput(
+        a, {{"RedrivePolicy", redrive_policy("other-dlq", 5)}});
+    std::thread deleter([&sqs, a]() { sqs.delete_queue(a); });
+    auto status = sqs.set_queue_attributes(&set);
+    EXPECT_NE(status, AttributeValueInvalid);
+    deleter.join();
+  }
+
+  // a queue of the same name must not inherit the deleted one's policy
+  create_queue(&sqs, "a");
+  EXPECT_TRUE(sqs.list_dead_letter_source_queues(other).value().empty());
+}
+
+// Polls the newest move task of `source` until it is no longer running.
+MessageMoveTaskResult wait_for_move_task(SQS* sqs, std::string source) {
+  auto input = ListMessageMoveTasksInput(source, 1);
+  for (int i = 0; i < 500; i++) {
+    auto results = sqs->list_message_move_tasks(&input).value()->results;
+    if (results[0].status != "RUNNING") {
+      return results[0];
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return sqs->list_message_move_tasks(&input).value()->results[0];
+}
+
+TEST(sqs_test, message_move_task_redrives_to_source) {
+  SQS sqs(ENDPOINT);
+  const std::string arn = "arn:aws:sqs:us-east-1:000000000000:";
+  auto dlq = create_queue(&sqs, "dlq");
+  auto qurl = create_queue(&sqs, "test-queue",
+                           {{"RedrivePolicy", redrive_policy("dlq", 1)},
+                            {"VisibilityTimeout", "0"}});
+  for (int i = 0; i < 250; i++) {
+    send_message(&sqs, dlq, "m" + std::to_string(i));
+  }
+
+  auto start = StartMessageMoveTaskInput(arn + "dlq", {}, {});
+  auto [status, res] = sqs.start_message_move_task(&start);
+  ASSERT_EQ(status, MoveTaskStarted);
+  auto result = wait_for_move_task(&sqs, arn + "dlq");
+  EXPECT_EQ(result.status, "COMPLETED");
+  EXPECT_EQ(result.approximate_number_of_messages_to_move, 250);
+  EXPECT_EQ(result.approximate_number_of_messages_moved, 250);
+  EXPECT_EQ(result.destination_arn, arn + "test-queue");
+  EXPECT_TRUE(result.task_handle.empty());
+  EXPECT_EQ(sqs.get_message_count(dlq), 0);
+  EXPECT_EQ(sqs.get_message_count(qurl), 250);
+
+  // receive counts start over, the first receive does not dead-letter them
+  auto msgs = receive(&sqs, qurl, 1);
+  ASSERT_EQ(msgs.size(), 1);
+  EXPECT_EQ(msgs[0].body.view(), "m0");
+  EXPECT_EQ(msgs[0].receive_count, 1);
+}
+
+TEST(sqs_test, message_move_task_can_be_cancelled) {
+  SQS sqs(ENDPOINT);
+  const std::string arn = "arn:aws:sqs:us-east-1:000000000000:";
+  auto dlq = create_queue(&sqs, "dlq");
+  create_queue(&sqs, "test-queue",
+               {{"RedrivePolicy", redrive_policy("dlq", 1)}});
+  auto other = create_queue(&sqs, "other");
+  for (int i = 0; i < 10; i++) {
+    send_message(&sqs, dlq, "m");
+  }
+
+  // one message per second leaves the task running
+  auto start = StartMessageMoveTaskInput(arn + "dlq", arn + "other", 1);
+  auto [status, res] = sqs.start_message_move_task(&start);
+  ASSERT_EQ(status, MoveTaskStarted);
+  EXPECT_EQ(sqs.start_message_move_task(&start).first, MoveTaskAlreadyRunning);
+
+  auto cancel = CancelMessageMoveTaskInput(res->task_handle);
+  auto cancelled = sqs.cancel_message_move_task(&cancel);
+  ASSERT_TRUE(cancelled.has_value());
+  EXPECT_LE(cancelled.value()->approximate_number_of_messages_moved, 1);
+  EXPECT_FALSE(sqs.cancel_message_move_task(&cancel).has_value());
+  EXPECT_EQ(wait_for_move_task(&sqs, arn + "dlq").status, "CANCELLED");
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  EXPECT_GE(sqs.get_message_count(dlq), 9);
+}
+
+TEST(sqs_test, message_move_task_rejects_invalid_tasks) {
+  SQS sqs(ENDPOINT);
+  const std::string arn = "arn:aws:sqs:us-east-1:000000000000:";
+  create_queue(&sqs, "dlq");
+  create_queue(&sqs, "a", {{"RedrivePolicy", redrive_policy("dlq", 1)}});
+  create_queue(&sqs, "b", {{"RedrivePolicy", redrive_policy("dlq", 1)}});
+
+  auto input = StartMessageMoveTaskInput(arn + "missing", {}, {});
+  EXPECT_EQ(sqs.start_message_move_task(&input).first, MoveSourceNotFound);
+  input = StartMessageMoveTaskInput(arn + "a", {}, {});
+  EXPECT_EQ(sqs.start_message_move_task(&input).first,
+            MoveSourceNotDeadLetterQueue);
+  // two sources leave the destination ambiguous
+  input = StartMessageMoveTaskInput(arn + "dlq", {}, {});
+  EXPECT_EQ(sqs.start_message_move_task(&input).first, MoveDestinationInvalid);
+  input = StartMessageMoveTaskInput(arn + "dlq", arn + "a", 501);
+  EXPECT_EQ(sqs.start_message_move_task(&input).first, MoveRateInvalid);
+}
+
+// SQS instances of a server with `count` shards.
+struct ShardedSQS {
+  std::vector<std::unique_ptr<Mailbox>> mailboxes;
+  std::vector<std::unique_ptr<SQS>> instances;
+  std::vector<SQS*> shards;
+
+  explicit ShardedSQS(size_t count) {
+    std::vector<Shard> all;
+    for (size_t i = 0; i < count; i++) {
+      mailboxes.push_back(std::make_unique<Mailbox>([]() {}));
+      instances.push_back(std::make_unique<SQS>(ENDPOINT));
+      shards.push_back(instances.back().get());
+      all.push_back(Shard{shards.back(), mailboxes.back().get()});
+    }
+    for (size_t i = 0; i < count; i++) {
+      shards[i]->join_shards(all, i);
+    }
+  }
+
+  SQS* owner(const std::string& qname) {
+    return shards[shard_of(qname, shards.size())];
+  }
+
+  // runs what the shards posted each other until none is left
+  void settle() {
+    size_t ran;
+    do {
+      ran = 0;
+      for (auto& mailbox : mailboxes) {
+        ran += mailbox->drain();
+      }
+    } while (ran > 0);
+  }
+};
+
+// A queue name starting with `prefix` that another shard owns than `qname`.
+std::string name_on_other_shard(const std::string& prefix,
+                                const std::string& qname, size_t shards) {
+  for (int i = 0;; i++) {
+    auto name = prefix + std::to_string(i);
+    if (shard_of(name, shards) != shard_of(qname, shards)) {
+      return name;
+    }
+  }
+}
+
+TEST(sqs_test, sharded_list_queues_covers_all_shards) {
+  ShardedSQS sqs(4);
+  std::set<size_t> owners;
+  std::vector<std::string> qurls;
+  for (int i = 0; i < 10; i++) {
+    auto qname = "queue-" + std::to_string(i);
+    owners.insert(shard_of(qname, 4));
+    qurls.push_back(create_queue(sqs.owner(qname), qname));
+  }
+  ASSERT_GT(owners.size(), 1);
+  // the other shards learn of the queues from their mailboxes
+  size_t owned = 0;
+  for (int i = 0; i < 10; i++) {
+    owned += shard_of("queue-" + std::to_string(i), 4) == 0;
+  }
+  auto unsettled = ListQueuesInput("queue-", {}, {});
+  EXPECT_EQ(sqs.shards[0]->list_queues(&unsettled).second->queues.size(),
+            owned);
+  sqs.settle();
+  // queues are only found on their owner
+  EXPECT_FALSE(sqs.shards[(shard_of("queue-0", 4) + 1) % 4]
+                   ->get_queue_url("queue-0")
+                   .has_value());
+
+  std::vector<std::string> listed;
+  std::optional<std::string> next_token;
+  do {
+    auto input = ListQueuesInput("queue-", 3, next_token);
+    auto res = sqs.shards[0]->list_queues(&input).second;
+    EXPECT_LE(res->queues.size(), 3);
+    for (auto& queue : res->queues) {
+      listed.push_back(queue.queue_url);
+    }
+    next_token = res->next_token;
+  } while (next_token.has_value());
+  EXPECT_EQ(listed, qurls);
+}
+
+TEST(sqs_test, sharded_redrive_reaches_dead_letter_queue_of_other_shard) {
+  ShardedSQS sqs(4);
+  const std::string arn = "arn:aws:sqs:us-east-1:000000000000:";
+  auto dlq_name = name_on_other_shard("dlq-", "test-queue", 4);
+  auto dlq = create_queue(sqs.owner(dlq_name), dlq_name);
+  sqs.settle();
+  auto source = sqs.owner("test-queue");
+  auto qurl = create_queue(source, "test-queue",
+                           {{"RedrivePolicy", redrive_policy(dlq_name, 1)},
+                            {"VisibilityTimeout", "0"}});
+  send_message(source, qurl, "poison");
+  EXPECT_EQ(receive(source, qurl, 1).size(), 1);
+  EXPECT_EQ(receive(source, qurl, 1).size(), 0);
+  EXPECT_EQ(sqs.owner(dlq_name)->get_message_count(dlq), 0);
+  sqs.settle();
+  EXPECT_EQ(sqs.owner(dlq_name)->get_message_count(dlq), 1);
+  EXPECT_EQ(sqs.owner(dlq_name)->list_dead_letter_source_queues(dlq).value(),
+            std::vector<std::string>{qurl});
+
+  // the task runs on the dead-letter queue's shard, its handle says so
+  auto start = StartMessageMoveTaskInput(arn + dlq_name, {}, {});
+  auto [status, res] = sqs.owner(dlq_name)->start_message_move_task(&start);
+  ASSERT_EQ(status, MoveTaskStarted);
+  EXPECT_EQ(move_task_shard(res->task_handle, 4), shard_of(dlq_name, 4));
+  EXPECT_FALSE(move_task_shard("not-a-handle", 4).has_value());
+  auto result = wait_for_move_task(sqs.owner(dlq_name), arn + dlq_name);
+  EXPECT_EQ(result.status, "COMPLETED");
+  sqs.settle();
+  EXPECT_EQ(source->get_message_count(qurl), 1);
+}
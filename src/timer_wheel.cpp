@@ -0,0 +1,99 @@
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+
+namespace sqscpp {
+TimerWheel::TimerWheel() : current(0), count(0) {}
+
+void TimerWheel::place(Entry entry) {
+  // entries too far ahead stay on the top level until cascaded closer
+  auto delta = entry.due - current;
+  int level = 0;
+  while (level < LEVELS - 1 && delta >= 1L << (LEVEL_BITS * (level + 1))) {
+    level++;
+  }
+  auto shift = LEVEL_BITS * level;
+  long at = entry.due;
+  if (level == LEVELS - 1 && delta >= 1L << (shift + LEVEL_BITS)) {
+    at = current + (1L << (shift + LEVEL_BITS)) - 1;
+  }
+  (*levels)[level][(at >> shift) & (WHEEL_SIZE - 1)].push_back(entry);
+}
+
+void TimerWheel::insert(long due, uint32_t id, long ts) {
+  if (levels == nullptr) {
+    levels = std::make_unique<Levels>();
+  }
+  if (count == 0) {
+    current = ts;
+  }
+  place(Entry{std::max(due, current + 1), id});
+  count++;
+}
+
+void TimerWheel::advance(long ts, const std::function<void(uint32_t)>& fn) {
+  while (count > 0 && current < ts) {
+    current++;
+    // a level wrapped around, spread the next bucket above it over the
+    // levels below, highest first
+    int top = 0;
+    while (top < LEVELS - 1 &&
+           (current & ((1L << (LEVEL_BITS * (top + 1))) - 1)) == 0) {
+      top++;
+    }
+    for (int level = top; level > 0; level--) {
+      auto shift = LEVEL_BITS * level;
+      auto& bucket = (*levels)[level][(current >> shift) & (WHEEL_SIZE - 1)];
+      auto cascaded = std::move(bucket);
+      bucket.clear();
+      for (const auto& entry : cascaded) {
+        place(entry);
+      }
+    }
+
+    auto& bucket = (*levels)[0][current & (WHEEL_SIZE - 1)];
+    for (const auto& entry : bucket) {
+      fn(entry.id);
+    }
+    count -= bucket.size();
+    bucket.clear();
+  }
+  current = std::max(current, ts);
+}
+
+std::optional<long> TimerWheel::next_due() {
+  if (count == 0) {
+    return {};
+  }
+
+  // a higher level can hold ids due before those of a lower one until it is
+  // cascaded, so every level bounds the result
+  auto due = current + (1L << (LEVEL_BITS * LEVELS));
+  for (int level = 0; level < LEVELS; level++) {
+    auto shift = LEVEL_BITS * level;
+    auto base = current >> shift;
+    for (long i = 1; i <= WHEEL_SIZE; i++) {
+      if (!(*levels)[level][(base + i) & (WHEEL_SIZE - 1)].empty()) {
+        due = std::min(due, std::max((base + i) << shift, current + 1));
+        break;
+      }
+    }
+  }
+  return due;
+}
+
+size_t TimerWheel::size() { return count; }
+
+void TimerWheel::for_each(const std::function<void(uint32_t)>& fn) {
+  if (levels == nullptr) {
+    return;
+  }
+  for (const auto& level : *levels) {
+    for (const auto& bucket : level) {
+      for (const auto& entry : bucket) {
+        fn(entry.id);
+      }
+    }
+  }
+}
+}  // namespace sqscpp
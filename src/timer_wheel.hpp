@@ -0,0 +1,58 @@
+#ifndef SQSCPP_TIMER_WHEEL_H
+#define SQSCPP_TIMER_WHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace sqscpp {
+// Hierarchical timing wheel of ids due at a time in seconds.
+//
+// Level `l` has WHEEL_SIZE buckets of WHEEL_SIZE^l seconds each. insert puts
+// an id straight into the bucket of the lowest level covering its due time.
+// advance walks the cursor second by second, and whenever a level wraps
+// around the next bucket of the level above is cascaded into the lower ones,
+// so an id is moved at most once per level before it is due. Ids due beyond
+// the range of the top level wait in its buckets and are placed again when
+// cascaded.
+//
+// TimerWheel is not synchronised by itself, callers serialise access to it.
+class TimerWheel {
+ private:
+  static constexpr int LEVEL_BITS = 6;
+  static constexpr int WHEEL_SIZE = 1 << LEVEL_BITS;
+  static constexpr int LEVELS = 4;
+
+  struct Entry {
+    long due;
+    uint32_t id;
+  };
+  using Bucket = std::vector<Entry>;
+  using Levels = std::array<std::array<Bucket, WHEEL_SIZE>, LEVELS>;
+
+  // allocated on first insert, idle queues do not pay for the buckets
+  std::unique_ptr<Levels> levels;
+  // every id due at or before `current` has been returned by advance
+  long current;
+  size_t count;
+
+  void place(Entry entry);
+
+ public:
+  TimerWheel();
+  // O(1), ids due at or before the cursor are returned by the next advance
+  void insert(long due, uint32_t id, long ts);
+  // Moves the cursor to `ts`, calling `fn` with every id due by then in
+  // order of their due time.
+  void advance(long ts, const std::function<void(uint32_t)>& fn);
+  // earliest time an id may be due, can be earlier than the actual one
+  std::optional<long> next_due();
+  size_t size();
+  void for_each(const std::function<void(uint32_t)>& fn);
+};
+}  // namespace sqscpp
+
+#endif  // SQSCPP_TIMER_WHEEL_H
@@ -0,0 +1,70 @@
+#include "timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace sqscpp;
+
+std::vector<uint32_t> advance(TimerWheel& wheel, long ts) {
+  std::vector<uint32_t> due;
+  wheel.advance(ts, [&due](uint32_t id) { due.push_back(id); });
+  return due;
+}
+
+TEST(timer_wheel_test, returns_ids_when_due) {
+  TimerWheel wheel;
+  wheel.insert(1005, 1, 1000);
+  wheel.insert(1002, 2, 1000);
+
+  EXPECT_EQ(advance(wheel, 1001).size(), 0);
+  EXPECT_EQ(advance(wheel, 1004), std::vector<uint32_t>{2});
+  EXPECT_EQ(wheel.size(), 1);
+  EXPECT_EQ(advance(wheel, 1005), std::vector<uint32_t>{1});
+  EXPECT_EQ(wheel.size(), 0);
+}
+
+TEST(timer_wheel_test, returns_ids_in_due_order_across_levels) {
+  TimerWheel wheel;
+  std::vector<long> delays = {900, 3, 64, 4097, 65, 63, 300000, 1};
+  for (uint32_t i = 0; i < delays.size(); i++) {
+    wheel.insert(1000 + delays[i], i, 1000);
+  }
+
+  std::vector<uint32_t> due = advance(wheel, 1000 + 300000);
+  EXPECT_EQ(due, (std::vector<uint32_t>{7, 1, 5, 2, 4, 0, 3, 6}));
+}
+
+TEST(timer_wheel_test, returns_ids_not_before_due) {
+  TimerWheel wheel;
+  for (long delay = 1; delay < 5000; delay += 7) {
+    wheel.insert(1000 + delay, delay, 1000);
+  }
+
+  for (long ts = 1000; wheel.size() > 0; ts++) {
+    for (auto id : advance(wheel, ts)) {
+      EXPECT_EQ(1000 + id, ts);
+    }
+  }
+}
+
+TEST(timer_wheel_test, past_due_ids_return_on_next_advance) {
+  TimerWheel wheel;
+  wheel.insert(1010, 1, 1000);
+  advance(wheel, 1005);
+  wheel.insert(900, 2, 1005);
+
+  EXPECT_EQ(advance(wheel, 1006), std::vector<uint32_t>{2});
+}
+
+TEST(timer_wheel_test, next_due_bounds_earliest_id) {
+  TimerWheel wheel;
+  EXPECT_FALSE(wheel.next_due().has_value());
+
+  wheel.insert(1900, 1, 1000);
+  auto due = wheel.next_due();
+  ASSERT_TRUE(due.has_value());
+  EXPECT_GT(due.value(), 1000);
+  EXPECT_LE(due.value(), 1900);
+
+  wheel.insert(1010, 2, 1000);
+  EXPECT_EQ(wheel.next_due(), 1010);
+}
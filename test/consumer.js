@@ -21,11 +21,11 @@ async function main() {
             new ReceiveMessageCommand({
                 MaxNumberOfMessages: 2,
                 QueueUrl: SQS_QUEUE_URL,
+                WaitTimeSeconds: 20,
             }),
         )
 
         if (!Messages || Messages.length === 0) {
-            await delay(1000)
             continue;
         }
 